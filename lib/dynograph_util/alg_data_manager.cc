@@ -1,77 +1,110 @@
 #include "alg_data_manager.h"
 #include "logger.h"
 #include <stdlib.h>
-#include <stdio.h>
-#include <sys/stat.h>
+#include <algorithm>
 
 using namespace DynoGraph;
 
-AlgDataManager::AlgDataManager(int64_t nv, std::vector<std::string> alg_names)
+AlgDataManager::AlgDataManager(int64_t nv, std::vector<std::string> alg_names, int64_t num_alg_trials)
+: num_alg_trials(num_alg_trials)
 {
     using std::make_pair;
     for (std::string alg_name : alg_names)
     {
-        last_epoch_data.emplace(make_pair(alg_name, pvector<int64_t>(nv)));
         current_epoch_data.emplace(make_pair(alg_name, pvector<int64_t>(nv)));
+        // No need for a second copy if we never roll back
+        if (num_alg_trials > 1) {
+            last_epoch_data.emplace(make_pair(alg_name, pvector<int64_t>(nv)));
+        }
     }
 
     path = "";
     if (const char* filename = getenv("DYNOGRAPH_ALG_DATA_PATH"))
     {
         path = std::string(filename);
+        // Results are dumped as deltas against the previous epoch, starting from all zeros
+        for (std::string alg_name : alg_names) {
+            dumped_data.emplace(make_pair(alg_name, pvector<int64_t>(nv, 0)));
+        }
+        writer.reset(new AlgDataWriter());
     }
 }
 
 void
-AlgDataManager::next_epoch()
+AlgDataManager::begin_trial(int64_t alg_trial)
 {
-    // "last" <= "current" for each alg
-    for (auto& entry : current_epoch_data)
-    {
-        std::string alg_name = entry.first;
-        auto& last = last_epoch_data[alg_name];
-        auto& current = current_epoch_data[alg_name];
-        last = current;
-    }
-}
+    if (num_alg_trials < 2) { return; }
 
-void
-AlgDataManager::rollback()
-{
-    // "current" <= "last" for each alg
     for (auto& entry : current_epoch_data)
     {
         std::string alg_name = entry.first;
         auto& last = last_epoch_data[alg_name];
         auto& current = current_epoch_data[alg_name];
-        current = last;
+        if (alg_trial == 0) {
+            // Save the results of the previous epoch before the first trial modifies them
+            last = current;
+        } else if (alg_trial < num_alg_trials - 1) {
+            // Restore the results of the previous epoch, keeping the saved copy for the next trial
+            current = last;
+        } else {
+            // This is the last trial, so the saved copy can be handed over without copying
+            // It will be overwritten at the start of the next epoch
+            current.swap(last);
+        }
     }
 }
 
 void
-AlgDataManager::dump(int64_t epoch) const
+AlgDataManager::dump(int64_t epoch)
 {
     if (path.empty()) { return; }
 
-    // Create directory for this epoch
-    std::string path_root = path + "/" + std::to_string(epoch);
-    mkdir(path_root.c_str(), 0700);
-
-    // Write current epoch results to disk
     for (auto& entry : current_epoch_data)
     {
-        int64_t *ptr = entry.second.data();
-        size_t sz = entry.second.size();
         std::string alg_name = entry.first;
-        std::string full_path = path_root + "/" + alg_name;
-        FILE* fp = fopen(full_path.c_str(), "wb");
-        if (fp) {
-            fwrite(ptr, sizeof(int64_t), sz, fp);
-            fclose(fp);
-        } else {
-            DynoGraph::Logger::get_instance() << "WARNING: Unable to dump alg results to " << full_path << "\n";
+        const pvector<int64_t>& current = entry.second;
+        pvector<int64_t>& dumped = dumped_data[alg_name];
+        const int64_t nv = current.size();
+
+        // Epoch 0 of each trial is stored relative to all zeros, since it overwrites the previous trial's file
+        if (epoch == 0) { dumped.fill(0); }
+
+        // Find the values that changed since the last dump, in parallel chunks
+        const int64_t num_parts = 256;
+        const int64_t part_size = (nv + num_parts - 1) / num_parts;
+        std::vector<std::vector<int64_t>> part_indices(num_parts);
+        #pragma omp parallel for schedule(dynamic)
+        for (int64_t p = 0; p < num_parts; ++p) {
+            for (int64_t v = p * part_size; v < std::min(nv, (p + 1) * part_size); ++v) {
+                if (current[v] != dumped[v]) {
+                    part_indices[p].push_back(v);
+                    dumped[v] = current[v];
+                }
+            }
+        }
+
+        // Gather changes in order
+        std::vector<int64_t> indices;
+        std::vector<int64_t> values;
+        for (const std::vector<int64_t>& part : part_indices) {
+            indices.insert(indices.end(), part.begin(), part.end());
         }
+        values.reserve(indices.size());
+        for (int64_t v : indices) { values.push_back(current[v]); }
+
+        // Hand off to the background thread for writing
+        writer->write(path, epoch, alg_name, nv, std::move(indices), std::move(values));
+    }
+}
+
+int64_t
+AlgDataManager::get_num_bytes() const
+{
+    int64_t num_bytes = 0;
+    for (auto* data : {&current_epoch_data, &last_epoch_data, &dumped_data}) {
+        for (auto& entry : *data) { num_bytes += entry.second.size() * sizeof(int64_t); }
     }
+    return num_bytes;
 }
 
 DynoGraph::Range<int64_t>
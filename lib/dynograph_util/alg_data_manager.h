@@ -1,26 +1,38 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cinttypes>
 #include "pvector.h"
 #include "range.h"
+#include "alg_data_writer.h"
 
 namespace DynoGraph {
 
 class AlgDataManager
 {
 private:
+    // Copy of each alg's data from the start of the epoch, used to roll back between trials
+    // Only allocated when there is more than one trial per epoch
     std::map<std::string, pvector<int64_t>> last_epoch_data;
     std::map<std::string, pvector<int64_t>> current_epoch_data;
+    int64_t num_alg_trials;
+    // Values as of the last dump, used to compute deltas
+    // Only allocated when DYNOGRAPH_ALG_DATA_PATH is set
+    std::map<std::string, pvector<int64_t>> dumped_data;
+    std::unique_ptr<AlgDataWriter> writer;
     std::string path;
 public:
-    AlgDataManager(int64_t nv, std::vector<std::string> alg_names);
-    void next_epoch();
-    void rollback();
-    void dump(int64_t epoch) const;
+    AlgDataManager(int64_t nv, std::vector<std::string> alg_names, int64_t num_alg_trials = 1);
+    // Prepare alg data for a trial, so that each trial in an epoch starts with the same data
+    void begin_trial(int64_t alg_trial);
+    // Queue up changes since the last dump to be written in the background
+    void dump(int64_t epoch);
     DynoGraph::Range<int64_t> get_data_for_alg(std::string alg_name);
+    // Total size of the copies of alg data held for trials and dumps, in bytes
+    int64_t get_num_bytes() const;
 };
 
 } // end namespace DynoGraph
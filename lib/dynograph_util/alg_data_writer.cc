@@ -0,0 +1,160 @@
+#include "alg_data_writer.h"
+#include "logger.h"
+#include "varint.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <cstring>
+
+using namespace DynoGraph;
+
+static const char delta_magic[8] = {'D', 'G', 'D', 'E', 'L', 'T', 'A', '1'};
+
+struct DeltaHeader
+{
+    char magic[8];
+    int64_t nv;
+    int64_t num_changes;
+};
+
+static std::string
+delta_filename(std::string path, int64_t epoch, std::string alg_name)
+{
+    return path + "/" + std::to_string(epoch) + "/" + alg_name + ".delta";
+}
+
+AlgDataWriter::AlgDataWriter()
+: done(false)
+, writer_thread(&AlgDataWriter::run, this)
+{}
+
+AlgDataWriter::~AlgDataWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    queue_not_empty.notify_all();
+    writer_thread.join();
+}
+
+void
+AlgDataWriter::write(std::string path, int64_t epoch, std::string alg_name, int64_t nv,
+    std::vector<int64_t>&& indices, std::vector<int64_t>&& values)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    // Block if the writer thread has fallen too far behind
+    queue_not_full.wait(lock, [this]() { return queue.size() < max_queue_size; });
+    queue.push_back(Job{path, epoch, alg_name, nv, std::move(indices), std::move(values)});
+    lock.unlock();
+    queue_not_empty.notify_one();
+}
+
+void
+AlgDataWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        // Finish writing everything in the queue before exiting
+        queue_not_empty.wait(lock, [this]() { return done || !queue.empty(); });
+        if (queue.empty()) { break; }
+
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        queue_not_full.notify_one();
+        writeJob(job);
+        lock.lock();
+    }
+}
+
+void
+AlgDataWriter::writeJob(const Job& job)
+{
+    // Encode index gaps and values
+    std::vector<uint8_t> encoded;
+    int64_t prev_index = -1;
+    for (size_t i = 0; i < job.indices.size(); ++i) {
+        put_varint(encoded, job.indices[i] - prev_index - 1);
+        put_varint(encoded, job.values[i]);
+        prev_index = job.indices[i];
+    }
+
+    DeltaHeader header;
+    memcpy(header.magic, delta_magic, sizeof(delta_magic));
+    header.nv = job.nv;
+    header.num_changes = job.indices.size();
+
+    // Create directory for this epoch
+    std::string path_root = job.path + "/" + std::to_string(job.epoch);
+    mkdir(path_root.c_str(), 0700);
+
+    std::string full_path = delta_filename(job.path, job.epoch, job.alg_name);
+    FILE* fp = fopen(full_path.c_str(), "wb");
+    if (fp == NULL) {
+        DynoGraph::Logger::get_instance() << "WARNING: Unable to dump alg results to " << full_path << "\n";
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+           && fwrite(encoded.data(), sizeof(uint8_t), encoded.size(), fp) == encoded.size();
+    // fclose flushes buffered data, so it can fail too
+    if (fclose(fp) != 0) { ok = false; }
+    if (!ok) {
+        // A truncated delta would corrupt every later epoch when replayed
+        DynoGraph::Logger::get_instance() << "Failed to write alg results to " << full_path << "\n";
+        die();
+    }
+}
+
+pvector<int64_t>
+DynoGraph::read_alg_data(std::string path, std::string alg_name, int64_t epoch)
+{
+    Logger &logger = Logger::get_instance();
+    pvector<int64_t> data;
+    for (int64_t e = 0; e <= epoch; ++e)
+    {
+        std::string full_path = delta_filename(path, e, alg_name);
+        FILE* fp = fopen(full_path.c_str(), "rb");
+        struct stat st;
+        if (fp == NULL || stat(full_path.c_str(), &st) != 0) {
+            logger << "Failed to open " << full_path << "\n";
+            die();
+        }
+
+        // Check the header
+        DeltaHeader header;
+        if (fread(&header, sizeof(header), 1, fp) != 1
+         || memcmp(header.magic, delta_magic, sizeof(delta_magic)) != 0
+         || header.nv < 0 || (e > 0 && static_cast<size_t>(header.nv) != data.size()))
+        {
+            logger << "Invalid alg data delta: bad header in " << full_path << "\n";
+            die();
+        }
+        if (e == 0) { data = pvector<int64_t>(header.nv, 0); }
+
+        std::vector<uint8_t> encoded(st.st_size - sizeof(header));
+        if (fread(encoded.data(), sizeof(uint8_t), encoded.size(), fp) != encoded.size()) {
+            logger << "Failed to read " << full_path << "\n";
+            die();
+        }
+        fclose(fp);
+
+        // Apply changes
+        const uint8_t* pos = encoded.data();
+        const uint8_t* end = encoded.data() + encoded.size();
+        int64_t index = -1;
+        for (int64_t i = 0; i < header.num_changes; ++i) {
+            int64_t gap, value;
+            if (!get_varint(pos, end, gap) || !get_varint(pos, end, value)
+             || gap < 0 || index + gap + 1 >= header.nv)
+            {
+                logger << "Invalid alg data delta: corrupt data in " << full_path << "\n";
+                die();
+            }
+            index += gap + 1;
+            data[index] = value;
+        }
+    }
+    return data;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pvector.h"
+
+namespace DynoGraph {
+
+/*
+ * Algorithm result dumps
+ *
+ * Results for each epoch are written to <path>/<epoch>/<alg_name>.delta, storing only the
+ * vertices whose value changed since the previous epoch (epoch 0 is stored relative to all zeros).
+ * Each file holds a header (magic string "DGDELTA1", then nv and num_changes as int64_t),
+ * followed by (index gap, value) pairs encoded as varints.
+ * Use read_alg_data() or the read_alg_data utility to reconstruct the results for an epoch.
+ */
+
+// Writes alg data deltas to disk on a background thread, so dumping doesn't stall the benchmark
+class AlgDataWriter
+{
+private:
+    struct Job
+    {
+        std::string path;
+        int64_t epoch;
+        std::string alg_name;
+        int64_t nv;
+        std::vector<int64_t> indices;
+        std::vector<int64_t> values;
+    };
+
+    // Maximum number of deltas waiting to be written before write() blocks
+    static const size_t max_queue_size = 4;
+
+    std::deque<Job> queue;
+    bool done;
+    std::mutex mutex;
+    std::condition_variable queue_not_empty;
+    std::condition_variable queue_not_full;
+    std::thread writer_thread;
+
+    void run();
+    static void writeJob(const Job& job);
+
+public:
+    AlgDataWriter();
+    // Waits for all pending writes to finish
+    ~AlgDataWriter();
+    // Queue up the changed values for an alg, takes ownership of indices and values
+    void write(std::string path, int64_t epoch, std::string alg_name, int64_t nv,
+        std::vector<int64_t>&& indices, std::vector<int64_t>&& values);
+};
+
+// Reconstruct the results for an alg at the given epoch by replaying deltas from epoch 0
+pvector<int64_t> read_alg_data(std::string path, std::string alg_name, int64_t epoch);
+
+} // end namespace DynoGraph
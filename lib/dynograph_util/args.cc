@@ -19,13 +19,14 @@ static const option long_options[] = {
     {"num-trials" , required_argument, 0, 0},
     {"num-alg-trials", required_argument, 0, 0},
     {"sources-path", required_argument, 0, 0},
+    {"stream-window", required_argument, 0, 0},
     {"help"       , no_argument, 0, 0},
     {NULL         , 0, 0, 0}
 };
 
 static const std::pair<string, string> option_descriptions[] = {
     {"num-epochs" , "Number of epochs (algorithm updates) in the benchmark"},
-    {"input-path" , "File path to the graph edge list to load (.graph.el or .graph.bin)"},
+    {"input-path" , "File path to the graph edge list to load (.graph.el, .graph.bin or .graph.cbin)"},
     {"batch-size" , "Number of edges in each batch of insertions"},
     {"alg-names"  , "Algorithms to run in each epoch"},
     {"sort-mode"  , "Controls batch pre-processing: \n"
@@ -36,6 +37,7 @@ static const std::pair<string, string> option_descriptions[] = {
     {"num-trials" , "Number of times to repeat the benchmark"},
     {"num-alg-trials" , "Number of times to repeat algorithms in each epoch"},
     {"sources-path" , "File path to the list of source vertices to use for graph algorithms"},
+    {"stream-window" , "Number of batches to keep in memory when streaming a .graph.bin file (0 loads the whole file, default)"},
     {"help"       , "Print help"},
 };
 
@@ -63,6 +65,7 @@ Args::parse(int argc, char *argv[])
     args.num_trials = 1;
     args.num_alg_trials = 1;
     args.sources_path = "";
+    args.stream_window = 0;
 
     int option_index;
     while (1)
@@ -114,6 +117,9 @@ Args::parse(int argc, char *argv[])
         } else if (option_name == "sources-path") {
             args.sources_path = optarg;
 
+        } else if (option_name == "stream-window") {
+            args.stream_window = static_cast<int64_t>(std::stoll(optarg));
+
         } else if (option_name == "help") {
             print_help(argv[0]);
             die();
@@ -152,6 +158,9 @@ Args::validate() const
     if (num_alg_trials < 1) {
         oss << "\t--num-alg-trials must be positive\n";
     }
+    if (stream_window < 0) {
+        oss << "\t--stream-window must be non-negative\n";
+    }
 
     return oss.str();
 }
@@ -179,6 +188,7 @@ DynoGraph::operator <<(std::ostream& os, const Args& args)
         << "\"num_trials\":"  << args.num_trials << ","
         << "\"num_alg_trials\":"  << args.num_alg_trials << ","
         << "\"sources_path\":" << args.sources_path << ","
+        << "\"stream_window\":" << args.stream_window << ","
         << "\"sort_mode\":\""   << args.sort_mode << "\",";
 
     os << "\"alg_names\":[";
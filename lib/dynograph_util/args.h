@@ -34,6 +34,8 @@ struct Args
     int64_t num_alg_trials;
     // File path to the list of source vertices to use for graph algorithms
     std::string sources_path;
+    // Number of batches to keep in memory when streaming a .graph.bin file from disk (0 to preload the whole file)
+    int64_t stream_window;
 
     Args() = default;
     std::string validate() const;
@@ -1,4 +1,12 @@
 #include "batch.h"
+#include <algorithm>
+
+#if defined(_OPENMP)
+#include <omp.h>
+static int num_threads() { return omp_get_max_threads(); }
+#else
+static int num_threads() { return 1; }
+#endif
 
 using namespace DynoGraph;
 
@@ -38,69 +46,229 @@ Batch::filter(int64_t threshold)
     );
 }
 
+// Number of bits needed to represent values up to x
+static int
+bits_needed(uint64_t x)
+{
+    int bits = 0;
+    while (x > 0) { bits += 1; x >>= 1; }
+    return bits;
+}
+
+// Stable parallel LSD radix sort on an unsigned integer key extracted from each element
+// Sorts [begin, end) in place, using tmp (same size) as scratch space
+template<typename T, typename KeyFn>
+static void
+radix_sort(T* begin, T* end, T* tmp, int key_bits, KeyFn key)
+{
+    const int radix_bits = 8;
+    const int64_t num_buckets = 1 << radix_bits;
+    const int64_t n = end - begin;
+
+    // Each part of the array builds its own histogram, so the scatter can run in parallel
+    const int64_t num_parts = std::max<int64_t>(1, std::min<int64_t>(num_threads(), n / num_buckets));
+    const int64_t part_size = (n + num_parts - 1) / num_parts;
+    pvector<int64_t> offsets(num_parts * num_buckets);
+
+    T* src = begin;
+    T* dst = tmp;
+    for (int shift = 0; shift < key_bits; shift += radix_bits)
+    {
+        auto digit = [&](const T& x) { return (key(x) >> shift) & (num_buckets - 1); };
+
+        // Count digits in each part
+        #pragma omp parallel for schedule(static)
+        for (int64_t p = 0; p < num_parts; ++p) {
+            int64_t* counts = &offsets[p * num_buckets];
+            std::fill(counts, counts + num_buckets, 0);
+            for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+                counts[digit(src[i])] += 1;
+            }
+        }
+
+        // Convert counts to offsets, ordered by digit then by part to keep the sort stable
+        int64_t offset = 0;
+        bool all_same_digit = false;
+        for (int64_t b = 0; b < num_buckets; ++b) {
+            int64_t bucket_start = offset;
+            for (int64_t p = 0; p < num_parts; ++p) {
+                int64_t count = offsets[p * num_buckets + b];
+                offsets[p * num_buckets + b] = offset;
+                offset += count;
+            }
+            if (offset - bucket_start == n) { all_same_digit = true; }
+        }
+        // Nothing to do if every key has the same digit in this position
+        if (all_same_digit) { continue; }
+
+        // Scatter elements into place
+        #pragma omp parallel for schedule(static)
+        for (int64_t p = 0; p < num_parts; ++p) {
+            int64_t* pos = &offsets[p * num_buckets];
+            for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+                dst[pos[digit(src[i])]++] = src[i];
+            }
+        }
+        std::swap(src, dst);
+    }
+
+    // Make sure the result ends up in the original array
+    if (src != begin) { std::copy(src, src + n, begin); }
+}
+
 void
 Batch::dedup_and_sort_by_out_degree()
 {
-    // Sort to prepare for deduplication
-    auto by_src_dest_time = [](const Edge& a, const Edge& b) {
-        // Order by src ascending, then dest ascending, then timestamp descending
-        // This way the edge with the most recent timestamp will be picked when deduplicating
-        return (a.src != b.src) ? a.src < b.src
-             : (a.dst != b.dst) ? a.dst < b.dst
-             :  a.timestamp > b.timestamp;
-    };
-    std::sort(begin_iter, end_iter, by_src_dest_time);
+    if (size() == 0) { return; }
 
-    // Deduplicate the edge list
-    {
-        pvector<Edge> deduped_edges(size());
-        // Using std::unique_copy since there is no parallel version of std::unique
-        auto end = std::unique_copy(begin_iter, end_iter, deduped_edges.begin(),
-            // We consider only source and dest when searching for duplicates
-            // The input is sorted, so we'll only get the most recent timestamp
-            // BUG: Does not combine weights
-            [](const Edge& a, const Edge& b) { return a.src == b.src && a.dst == b.dst; });
-        // Copy deduplicated edges back into this batch
-        std::transform(deduped_edges.begin(), end, begin_iter,
-            [](const Edge& e) { return e; });
-        // Adjust size
-        size_t num_deduped_edges = (end - deduped_edges.begin());
-        end_iter = begin_iter + num_deduped_edges;
+    // Sort by src, then dest, so duplicate edges are next to each other
+    pvector<Edge> tmp(size());
+    int64_t max_id = this->max_vertex_id();
+    int vertex_bits = bits_needed(max_id);
+    if (2 * vertex_bits <= 64) {
+        // Pack src and dest into a single key
+        radix_sort(begin_iter, end_iter, tmp.begin(), 2 * vertex_bits,
+            [vertex_bits](const Edge& e) {
+                return (static_cast<uint64_t>(e.src) << vertex_bits) | static_cast<uint64_t>(e.dst);
+            });
+    } else {
+        // Vertex ID's are too large to pack, fall back to comparison sort
+        std::sort(begin_iter, end_iter, [](const Edge& a, const Edge& b) {
+            return (a.src != b.src) ? a.src < b.src : a.dst < b.dst;
+        });
     }
 
-    // Allocate an array with an entry for each vertex
-    pvector<int64_t> degrees(this->max_vertex_id()+1);
-    #pragma omp parallel for
-    for (int64_t i = 0; i < degrees.size(); ++i) {
-        degrees[i] = i;
+    dedup();
+    sort_by_out_degree();
+}
+
+void
+Batch::dedup()
+{
+    const int64_t n = size();
+    if (n == 0) { return; }
+    const Edge* edges = begin_iter;
+    auto starts_run = [edges](int64_t i) {
+        return i == 0 || edges[i-1].src != edges[i].src || edges[i-1].dst != edges[i].dst;
+    };
+
+    // Count the number of unique edges in each part of the batch
+    const int64_t num_parts = std::max<int64_t>(1, std::min<int64_t>(num_threads(), n / 1024));
+    const int64_t part_size = (n + num_parts - 1) / num_parts;
+    pvector<int64_t> part_offsets(num_parts + 1);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        int64_t count = 0;
+        for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+            if (starts_run(i)) { count += 1; }
+        }
+        part_offsets[p + 1] = count;
+    }
+    part_offsets[0] = 0;
+    for (int64_t p = 0; p < num_parts; ++p) {
+        part_offsets[p + 1] += part_offsets[p];
     }
 
-    // Count the degree of each vertex
-    auto pos = begin_iter;
-    #pragma omp parallel for schedule(static) firstprivate(pos)
-    for (size_t src = 0; src < degrees.size(); ++src)
-    {
-        // Find the range of edges with src==src
-        Edge key = {src, 0, 0, 0};
-        auto range = std::equal_range(pos, end_iter, key,
-            [](const Edge& a, const Edge& b) {
-                return a.src < b.src;
+    // Combine each run of duplicates into a single edge
+    // Each part handles the runs that start within it, even if they continue into the next part
+    pvector<Edge> deduped_edges(part_offsets[num_parts]);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        Edge* out = &deduped_edges[part_offsets[p]];
+        for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+            if (!starts_run(i)) { continue; }
+            // Sum up the weights, and keep the most recent timestamp
+            Edge e = edges[i];
+            for (int64_t j = i + 1; j < n && !starts_run(j); ++j) {
+                e.weight += edges[j].weight;
+                e.timestamp = std::max(e.timestamp, edges[j].timestamp);
             }
-        );
-        // Calculate length of range
-        // Since there are no duplicates, this is the degree of src
-        degrees[src] = range.second - range.first;
-        // Reuse end of range as start of next search
-        pos = range.second;
+            *out++ = e;
+        }
     }
 
-    // Sort by out degree descending, src then dst
-    auto by_out_degree = [&degrees](const Edge& a, const Edge& b) {
-        if (degrees[a.src] != degrees[b.src]) {
-            return degrees[a.src] > degrees[b.src];
-        } else {
-            return degrees[a.dst] > degrees[b.dst];
+    // Copy deduplicated edges back into this batch
+    std::copy(deduped_edges.begin(), deduped_edges.end(), begin_iter);
+    end_iter = begin_iter + deduped_edges.size();
+}
+
+void
+Batch::sort_by_out_degree()
+{
+    const int64_t n = size();
+    if (n == 0) { return; }
+    const Edge* edges = begin_iter;
+
+    // Since the batch is sorted by src, each vertex's out edges form a single run
+    // Find where each run begins, the out degree of a vertex is the length of its run
+    auto starts_run = [edges](int64_t i) {
+        return i == 0 || edges[i-1].src != edges[i].src;
+    };
+    const int64_t num_parts = std::max<int64_t>(1, std::min<int64_t>(num_threads(), n / 1024));
+    const int64_t part_size = (n + num_parts - 1) / num_parts;
+    pvector<int64_t> part_offsets(num_parts + 1);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        int64_t count = 0;
+        for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+            if (starts_run(i)) { count += 1; }
         }
+        part_offsets[p + 1] = count;
+    }
+    part_offsets[0] = 0;
+    for (int64_t p = 0; p < num_parts; ++p) {
+        part_offsets[p + 1] += part_offsets[p];
+    }
+    const int64_t num_runs = part_offsets[num_parts];
+    pvector<int64_t> run_starts(num_runs + 1);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        int64_t* out = &run_starts[part_offsets[p]];
+        for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+            if (starts_run(i)) { *out++ = i; }
+        }
+    }
+    run_starts[num_runs] = n;
+
+    int64_t max_degree = 0;
+    #pragma omp parallel for schedule(static) reduction(max : max_degree)
+    for (int64_t r = 0; r < num_runs; ++r) {
+        max_degree = std::max(max_degree, run_starts[r + 1] - run_starts[r]);
+    }
+
+    // Vertices that only appear as a dst have no run, and an out degree of zero
+    auto degree_of = [&](int64_t v) -> int64_t {
+        const int64_t* first = run_starts.begin();
+        const int64_t* last = run_starts.begin() + num_runs;
+        const int64_t* r = std::lower_bound(first, last, v,
+            [edges](int64_t start, int64_t v) { return edges[start].src < v; });
+        if (r == last || edges[*r].src != v) { return 0; }
+        return *(r + 1) - *r;
     };
-    std::sort(begin_iter, end_iter, by_out_degree);
+
+    // Compute the sort key of each edge once, instead of on every pass of the radix sort
+    int degree_bits = bits_needed(max_degree);
+    struct KeyedIndex { uint64_t key; int64_t index; };
+    pvector<KeyedIndex> keys(n);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t r = 0; r < num_runs; ++r) {
+        uint64_t src_key = max_degree - (run_starts[r + 1] - run_starts[r]);
+        for (int64_t i = run_starts[r]; i < run_starts[r + 1]; ++i) {
+            uint64_t dst_key = max_degree - degree_of(edges[i].dst);
+            keys[i] = {(src_key << degree_bits) | dst_key, i};
+        }
+    }
+
+    // Sort by out degree descending, src then dst
+    pvector<KeyedIndex> tmp_keys(n);
+    radix_sort(keys.begin(), keys.end(), tmp_keys.begin(), 2 * degree_bits,
+        [](const KeyedIndex& k) { return k.key; });
+
+    // Move the edges into sorted order
+    pvector<Edge> sorted(n);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        sorted[i] = edges[keys[i].index];
+    }
+    std::copy(sorted.begin(), sorted.end(), begin_iter);
 }
@@ -17,7 +17,13 @@ public:
     int64_t num_vertices_affected() const;
     int64_t max_vertex_id() const;
     void filter(int64_t threshold);
+    // Combines duplicate edges (summing weights and keeping the latest timestamp),
+    // then sorts by out degree descending
     void dedup_and_sort_by_out_degree();
+    // Combines duplicate edges in a batch that is already sorted by src and dst
+    void dedup();
+    // Sorts by out degree descending, for a batch that is already sorted by src and dst with no duplicates
+    void sort_by_out_degree();
 
     bool is_directed() const { return true; }
     virtual ~Batch() = default;
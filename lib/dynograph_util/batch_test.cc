@@ -1,5 +1,7 @@
 #include "batch.h"
 #include <gtest/gtest.h>
+#include <map>
+#include <random>
 
 using namespace DynoGraph;
 
@@ -70,6 +72,62 @@ TEST(BatchTest, DedupAndSortBatch) {
     ASSERT_PRED2(batches_equal, test_batch, golden_batch);
 }
 
+// Make sure duplicate edges are combined when deduplicating
+TEST(BatchTest, DedupCombinesWeights) {
+    std::vector<Edge> edges_before = {
+        {2, 3, 1, 200},
+        {1, 2, 5, 100},
+        {2, 3, 2, 400},
+        {2, 3, 4, 300},
+    };
+    Batch test_batch(edges_before);
+    test_batch.dedup_and_sort_by_out_degree();
+    ASSERT_EQ(test_batch.size(), 2);
+    ASSERT_EQ(test_batch[0], (Edge{1, 2, 5, 100}));
+    ASSERT_EQ(test_batch[1], (Edge{2, 3, 7, 400}));
+}
+
+// Make sure the result matches a simple serial implementation on a larger batch
+TEST(BatchTest, DedupAndSortLargeBatch) {
+    std::mt19937_64 rng(1234);
+    std::uniform_int_distribution<int64_t> vertex(0, 300);
+    std::vector<Edge> edges(100000);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        edges[i] = {vertex(rng), vertex(rng), 1, static_cast<int64_t>(i)};
+    }
+
+    // Compute expected result using std::map
+    std::map<std::pair<int64_t, int64_t>, Edge> expected_edges;
+    std::map<int64_t, int64_t> degrees;
+    for (const Edge& e : edges) {
+        auto key = std::make_pair(e.src, e.dst);
+        auto it = expected_edges.find(key);
+        if (it == expected_edges.end()) {
+            expected_edges[key] = e;
+            degrees[e.src] += 1;
+        } else {
+            it->second.weight += e.weight;
+            it->second.timestamp = std::max(it->second.timestamp, e.timestamp);
+        }
+    }
+
+    Batch test_batch(edges);
+    test_batch.dedup_and_sort_by_out_degree();
+    ASSERT_EQ(test_batch.size(), expected_edges.size());
+    for (size_t i = 0; i < test_batch.size(); ++i) {
+        const Edge& e = test_batch[i];
+        ASSERT_EQ(e, expected_edges[std::make_pair(e.src, e.dst)]);
+        if (i > 0) {
+            // Check order: out degree of src descending, then out degree of dst descending
+            const Edge& prev = test_batch[i-1];
+            ASSERT_GE(degrees[prev.src], degrees[e.src]);
+            if (degrees[prev.src] == degrees[e.src]) {
+                ASSERT_GE(degrees[prev.dst], degrees[e.dst]);
+            }
+        }
+    }
+}
+
 TEST(BatchTest, GetMaxVertexId) {
     std::vector<Edge> edges = {
         {1, 2, 1, 100},
@@ -2,6 +2,7 @@
 #include "helpers.h"
 #include "rmat_dataset.h"
 #include "edgelist_dataset.h"
+#include "streaming_dataset.h"
 
 using namespace DynoGraph;
 //using std::cerr;
@@ -21,7 +22,7 @@ Benchmark::Benchmark(Args& args)
 // Store the max vertex id of the dataset
 , max_vertex_id(dataset->getMaxVertexId())
 // Allocate data for graph algorithms
-, alg_data_manager(max_vertex_id + 1, args.alg_names)
+, alg_data_manager(max_vertex_id + 1, args.alg_names, args.num_alg_trials)
 // Load source vertices, if specified
 , sources(load_sources_from_file(args.sources_path, max_vertex_id))
 // Get a reference to the logger
@@ -47,7 +48,12 @@ DynoGraph::create_dataset(const Args &args)
         }
         dataset = make_shared<RmatDataset>(args, rmat_args);
 
+    } else if (args.stream_window > 0) {
+        // Read batches from disk as they are needed instead of loading the whole file
+        dataset = make_shared<StreamingDataset>(args);
+
     } else if (has_suffix(args.input_path, ".graph.bin")
+    || has_suffix(args.input_path, ".graph.cbin")
     || has_suffix(args.input_path, ".graph.el"))
     {
         dataset = make_shared<EdgeListDataset>(args);
@@ -65,7 +71,8 @@ DynoGraph::create_dataset(const Args &args)
 }
 
 shared_ptr<Batch>
-DynoGraph::get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode)
+DynoGraph::get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode,
+    CumulativeSnapshot *snapshot)
 {
     int64_t threshold = dataset.getTimestampForWindow(batchId);
 
@@ -88,6 +95,10 @@ DynoGraph::get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT
         }
         case Args::SORT_MODE::SNAPSHOT:
         {
+            if (snapshot) {
+                // Merge new batches into the previous snapshot
+                return snapshot->update(batchId, dataset);
+            }
             shared_ptr<Batch> cumulative_snapshot = make_shared<ConcreteBatch>(
                     std::move(*dataset.getBatchesUpTo(batchId))
             );
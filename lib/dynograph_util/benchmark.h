@@ -13,6 +13,7 @@
 #include "args.h"
 #include "idataset.h"
 #include "alg_data_manager.h"
+#include "cumulative_snapshot.h"
 #include "dynamic_graph.h"
 #include "logger.h"
 #include <hooks.h>
@@ -22,8 +23,10 @@ namespace DynoGraph {
 std::shared_ptr<IDataset>
 create_dataset(const Args &args);
 
+// If snapshot is provided, it is updated incrementally in SNAPSHOT mode instead of rebuilding from scratch
 std::shared_ptr<Batch>
-get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode);
+get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode,
+    CumulativeSnapshot *snapshot = nullptr);
 
 bool
 enable_algs_for_batch(int64_t batch_id, int64_t num_batches, int64_t num_epochs);
@@ -39,10 +42,46 @@ protected:
     std::shared_ptr<IDataset> dataset;
     int64_t max_vertex_id;
     AlgDataManager alg_data_manager;
+    CumulativeSnapshot snapshot;
     std::vector<int64_t> sources;
     Logger& logger;
     Hooks& hooks;
 
+    // Number of source vertices to use for each alg
+    static int64_t
+    num_sources_for_alg(const std::string &alg_name)
+    {
+        if (alg_name == "bfs" || alg_name == "top_down_bfs" || alg_name == "ms_bfs" || alg_name == "sssp") { return 64; }
+        else if (alg_name == "bc" || alg_name == "bc_updating") { return 128; }
+        // Incremental search only keeps the levels from one source
+        else if (alg_name == "bfs_updating") { return 1; }
+        else { return 0; }
+    }
+
+    // Pick source vertex(s) for the alg from the highest degree vertices in the graph
+    // high_degree_vertices caches the result for the current epoch, in order of increasing degree,
+    // so the graph is only scanned once no matter how many algs and trials need sources
+    template<typename graph_t>
+    void
+    pick_sources(const graph_t &graph, const std::string &alg_name, std::vector<int64_t> &high_degree_vertices)
+    {
+        int64_t num_sources = num_sources_for_alg(alg_name);
+        if (static_cast<int64_t>(high_degree_vertices.size()) < num_sources) {
+            // Fetch enough for any alg, so we don't have to do this again
+            int64_t max_sources = 0;
+            for (const std::string &name : args.alg_names) {
+                max_sources = std::max(max_sources, num_sources_for_alg(name));
+            }
+            high_degree_vertices = graph.get_high_degree_vertices(max_sources);
+        }
+        // The top n vertices are at the end of the list
+        num_sources = std::min(num_sources, static_cast<int64_t>(high_degree_vertices.size()));
+        sources.assign(high_degree_vertices.end() - num_sources, high_degree_vertices.end());
+        if (sources.size() == 1) {
+            hooks.set_stat("source_vertex", sources[0]);
+        }
+    }
+
 public:
 
     /* Initializes the benchmark, including the graph dataset and other
@@ -96,37 +135,33 @@ public:
             // Graph algorithm benchmarks
             if (enable_algs_for_batch(batch_id, num_batches, args.num_epochs))
             {
+                // Highest degree vertices in the graph for this epoch, shared by all algs and trials
+                std::vector<int64_t> high_degree_vertices;
                 for (int64_t alg_trial = 0; alg_trial < args.num_alg_trials; ++alg_trial)
                 {
                     // When we do multiple trials, algs should start with the same data each time
-                    if (alg_trial != 0) { alg_data_manager.rollback(); }
+                    alg_data_manager.begin_trial(alg_trial);
 
                     // Run each alg
                     for (std::string alg_name : args.alg_names)
                     {
                         if (args.sources_path.empty()) {
-                            // Pick source vertex(s)
-                            int64_t num_sources;
-                            if (alg_name == "bfs" || alg_name == "sssp") { num_sources = 64; }
-                            else if (alg_name == "bc") { num_sources = 128; }
-                            else { num_sources = 0; }
-                            sources = graph.get_high_degree_vertices(num_sources);
-                            if (sources.size() == 1) {
-                                hooks.set_stat("source_vertex", sources[0]);
-                            }
+                            pick_sources(graph, alg_name, high_degree_vertices);
                         }
 
                         logger << "Running " << alg_name << " for epoch " << epoch << "\n";
                         hooks.set_stat("alg_trial", alg_trial);
                         hooks.set_stat("num_vertices", graph.get_num_vertices());
                         hooks.set_stat("num_edges", graph.get_num_edges());
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+                        hooks.set_stat("alg_data_manager_bytes", alg_data_manager.get_num_bytes());
+#endif
                         hooks.region_begin(alg_name);
                         graph.update_alg(alg_name, sources, alg_data_manager.get_data_for_alg(alg_name));
                         hooks.region_end();
                     }
                 }
                 alg_data_manager.dump(epoch);
-                alg_data_manager.next_epoch();
                 epoch += 1;
                 assert(epoch <= args.num_epochs);
             }
@@ -157,7 +192,7 @@ public:
 
                 // This batch will be a cumulative, filtered snapshot of all the edges in previous batches
                 hooks.region_begin("preprocess");
-                std::shared_ptr<DynoGraph::Batch> batch = get_preprocessed_batch(batch_id, *dataset, args.sort_mode);
+                std::shared_ptr<DynoGraph::Batch> batch = get_preprocessed_batch(batch_id, *dataset, args.sort_mode, &snapshot);
                 hooks.region_end();
 
                 logger << "Initializing graph for epoch " << epoch << "\n";
@@ -168,37 +203,33 @@ public:
                 hooks.region_end();
 
                 // Graph algorithm benchmarks
+                // Highest degree vertices in the graph for this epoch, shared by all algs and trials
+                std::vector<int64_t> high_degree_vertices;
                 for (int64_t alg_trial = 0; alg_trial < args.num_alg_trials; ++alg_trial)
                 {
                     // When we do multiple trials, algs should start with the same data each time
-                    if (alg_trial != 0) { alg_data_manager.rollback(); }
+                    alg_data_manager.begin_trial(alg_trial);
 
                     // Run each alg
                     for (std::string alg_name : args.alg_names)
                     {
                         if (args.sources_path.empty()) {
-                            // Pick source vertex(s)
-                            int64_t num_sources;
-                            if (alg_name == "bfs" || alg_name == "sssp") { num_sources = 64; }
-                            else if (alg_name == "bc") { num_sources = 128; }
-                            else { num_sources = 0; }
-                            sources = graph->get_high_degree_vertices(num_sources);
-                            if (sources.size() == 1) {
-                                hooks.set_stat("source_vertex", sources[0]);
-                            }
+                            pick_sources(*graph, alg_name, high_degree_vertices);
                         }
 
                         logger << "Running " << alg_name << " for epoch " << epoch << "\n";
                         hooks.set_stat("alg_trial", alg_trial);
                         hooks.set_stat("num_vertices", graph->get_num_vertices());
                         hooks.set_stat("num_edges", graph->get_num_edges());
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+                        hooks.set_stat("alg_data_manager_bytes", alg_data_manager.get_num_bytes());
+#endif
                         hooks.region_begin(alg_name);
                         graph->update_alg(alg_name, sources, alg_data_manager.get_data_for_alg(alg_name));
                         hooks.region_end();
                     }
                 }
                 alg_data_manager.dump(epoch);
-                alg_data_manager.next_epoch();
                 epoch += 1;
                 assert(epoch <= args.num_epochs);
 
@@ -211,6 +242,7 @@ public:
         assert(epoch == args.num_epochs);
         // Reset dataset for next trial
         dataset->reset();
+        snapshot.reset();
     }
 
     template<typename graph_t>
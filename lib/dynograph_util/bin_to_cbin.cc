@@ -0,0 +1,40 @@
+#include "compressed_edge_list.h"
+#include "edge.h"
+#include "logger.h"
+#include "pvector.h"
+#include <string>
+
+using namespace DynoGraph;
+
+// Converts a binary edge list (.graph.bin) on stdin to a compressed edge list (.graph.cbin) on stdout
+int main(int argc, const char* argv[])
+{
+    Logger& logger = Logger::get_instance();
+
+    // Optionally override the number of edges in each compressed block
+    int64_t cbin_block_size = cbin_default_block_size;
+    if (argc > 1) {
+        cbin_block_size = static_cast<int64_t>(std::stoll(argv[1]));
+        if (cbin_block_size < 1) {
+            logger << "Usage: " << argv[0] << " [block_size] < input.graph.bin > output.graph.cbin\n";
+            die();
+        }
+    }
+    CompressedEdgeWriter writer(stdout, cbin_block_size);
+
+    // Fixed size buffer of binary edges
+    size_t block_size = 1024 * 1024;
+    pvector<Edge> edges(block_size);
+
+    // Read in edges one block at a time
+    while (size_t rc = fread(&edges[0], sizeof(Edge), block_size, stdin))
+    {
+        if (rc > block_size) {
+            logger << "Bad return code from fread()\n";
+            die();
+        }
+        writer.write(&edges[0], &edges[0] + rc);
+    }
+    writer.finish();
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include "compressed_edge_list.h"
+#include "logger.h"
+#include "varint.h"
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace DynoGraph;
+
+static const char cbin_magic[8] = {'D', 'G', 'C', 'B', 'I', 'N', '0', '1'};
+
+struct CompressedFooter
+{
+    int64_t num_edges;
+    int64_t block_size;
+    int64_t num_blocks;
+    char magic[8];
+};
+
+void
+DynoGraph::encode_edge_block(const Edge* begin, const Edge* end, std::vector<uint8_t>& out)
+{
+    // Timestamps are sorted, so store the difference from the previous edge
+    int64_t prev_timestamp = 0;
+    for (const Edge* e = begin; e < end; ++e) {
+        put_varint(out, e->timestamp - prev_timestamp);
+        prev_timestamp = e->timestamp;
+    }
+    for (const Edge* e = begin; e < end; ++e) { put_varint(out, e->src); }
+    for (const Edge* e = begin; e < end; ++e) { put_varint(out, e->dst); }
+    // Weights are usually all the same, so store them as (weight, count) runs
+    for (const Edge* e = begin; e < end; ) {
+        const Edge* run_end = e + 1;
+        while (run_end < end && run_end->weight == e->weight) { ++run_end; }
+        put_varint(out, e->weight);
+        put_varint(out, run_end - e);
+        e = run_end;
+    }
+}
+
+bool
+DynoGraph::decode_edge_block(const uint8_t* begin, const uint8_t* end, int64_t num_edges, Edge* out)
+{
+    const uint8_t* pos = begin;
+    int64_t timestamp = 0;
+    for (int64_t i = 0; i < num_edges; ++i) {
+        int64_t delta;
+        if (!get_varint(pos, end, delta)) { return false; }
+        timestamp += delta;
+        out[i].timestamp = timestamp;
+    }
+    for (int64_t i = 0; i < num_edges; ++i) {
+        if (!get_varint(pos, end, out[i].src)) { return false; }
+    }
+    for (int64_t i = 0; i < num_edges; ++i) {
+        if (!get_varint(pos, end, out[i].dst)) { return false; }
+    }
+    for (int64_t i = 0; i < num_edges; ) {
+        int64_t weight, count;
+        if (!get_varint(pos, end, weight) || !get_varint(pos, end, count)) { return false; }
+        if (count < 1 || count > num_edges - i) { return false; }
+        for (int64_t j = 0; j < count; ++j) { out[i + j].weight = weight; }
+        i += count;
+    }
+    return pos == end;
+}
+
+CompressedEdgeWriter::CompressedEdgeWriter(FILE* fp, int64_t block_size)
+: fp(fp)
+, block_size(block_size)
+, num_edges(0)
+, offsets(1, 0)
+{}
+
+void
+CompressedEdgeWriter::flushBlocks(int64_t num_blocks)
+{
+    Logger &logger = Logger::get_instance();
+    const int64_t num_pending = pending.size();
+
+    // Encode each block independently
+    std::vector<std::vector<uint8_t>> encoded(num_blocks);
+    #pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < num_blocks; ++b) {
+        const Edge* begin = &pending[0] + b * block_size;
+        const Edge* end = &pending[0] + std::min(num_pending, (b + 1) * block_size);
+        encode_edge_block(begin, end, encoded[b]);
+    }
+
+    // Write them out in order
+    for (const std::vector<uint8_t>& block : encoded) {
+        if (fwrite(block.data(), sizeof(uint8_t), block.size(), fp) != block.size()) {
+            logger << "Failed to write compressed edge block\n";
+            die();
+        }
+        offsets.push_back(offsets.back() + block.size());
+    }
+
+    int64_t num_flushed = std::min(num_pending, num_blocks * block_size);
+    pending.erase(pending.begin(), pending.begin() + num_flushed);
+    num_edges += num_flushed;
+}
+
+void
+CompressedEdgeWriter::write(const Edge* begin, const Edge* end)
+{
+    pending.insert(pending.end(), begin, end);
+    int64_t num_full_blocks = pending.size() / block_size;
+    if (num_full_blocks > 0) { flushBlocks(num_full_blocks); }
+}
+
+void
+CompressedEdgeWriter::finish()
+{
+    Logger &logger = Logger::get_instance();
+    if (!pending.empty()) { flushBlocks(1); }
+
+    CompressedFooter footer;
+    footer.num_edges = num_edges;
+    footer.block_size = block_size;
+    footer.num_blocks = offsets.size() - 1;
+    memcpy(footer.magic, cbin_magic, sizeof(cbin_magic));
+
+    if (fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), fp) != offsets.size()
+     || fwrite(&footer, sizeof(footer), 1, fp) != 1)
+    {
+        logger << "Failed to write compressed edge index\n";
+        die();
+    }
+}
+
+void
+DynoGraph::read_compressed_edges(const std::string& path, pvector<Edge>& edges)
+{
+    Logger &logger = Logger::get_instance();
+    FILE* fp = fopen(path.c_str(), "rb");
+    struct stat st;
+    if (fp == NULL || stat(path.c_str(), &st) != 0)
+    {
+        logger << "Failed to open " << path << "\n";
+        die();
+    }
+
+    // Read the whole compressed file into memory
+    pvector<uint8_t> data(st.st_size);
+    if (fread(data.data(), sizeof(uint8_t), data.size(), fp) != data.size())
+    {
+        logger << "Failed to load graph from " << path << "\n";
+        die();
+    }
+    fclose(fp);
+
+    // Check the footer
+    CompressedFooter footer;
+    if (data.size() < sizeof(footer)) {
+        logger << "Invalid compressed edge list: " << path << " is truncated\n";
+        die();
+    }
+    memcpy(&footer, data.end() - sizeof(footer), sizeof(footer));
+    if (memcmp(footer.magic, cbin_magic, sizeof(cbin_magic)) != 0
+     || footer.num_edges < 0 || footer.block_size < 1 || footer.num_blocks < 0
+     || footer.num_blocks != (footer.num_edges + footer.block_size - 1) / footer.block_size
+     || (footer.num_blocks + 1) * sizeof(uint64_t) + sizeof(footer) > data.size())
+    {
+        logger << "Invalid compressed edge list: bad header in " << path << "\n";
+        die();
+    }
+
+    // Locate the block index
+    const size_t index_size = (footer.num_blocks + 1) * sizeof(uint64_t);
+    const uint8_t* index_begin = data.end() - sizeof(footer) - index_size;
+    std::vector<uint64_t> offsets(footer.num_blocks + 1);
+    memcpy(offsets.data(), index_begin, index_size);
+    const size_t data_size = index_begin - data.begin();
+    if (offsets.front() != 0 || offsets.back() != data_size
+     || !std::is_sorted(offsets.begin(), offsets.end()))
+    {
+        logger << "Invalid compressed edge list: bad block index in " << path << "\n";
+        die();
+    }
+
+    // Decode all the blocks in parallel
+    edges.resize(footer.num_edges);
+    bool valid = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&& : valid)
+    for (int64_t b = 0; b < footer.num_blocks; ++b) {
+        int64_t first_edge = b * footer.block_size;
+        int64_t n = std::min(footer.block_size, footer.num_edges - first_edge);
+        valid = decode_edge_block(data.begin() + offsets[b], data.begin() + offsets[b + 1], n, &edges[first_edge])
+            && valid;
+    }
+    if (!valid) {
+        logger << "Invalid compressed edge list: corrupt block in " << path << "\n";
+        die();
+    }
+}
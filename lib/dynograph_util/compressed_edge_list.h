@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "edge.h"
+#include "pvector.h"
+
+namespace DynoGraph {
+
+/*
+ * Compressed binary edge list format (.graph.cbin)
+ *
+ * Edges are split into fixed-size blocks which can be encoded and decoded independently.
+ * Within a block, each field is stored as a separate column:
+ *   - timestamps: first timestamp, followed by the difference from the previous edge
+ *   - sources and destinations: one value per edge
+ *   - weights: run-length encoded as (weight, count) pairs
+ * All values are zigzag-encoded and stored as LEB128 varints.
+ *
+ * The blocks are followed by a table of num_blocks+1 byte offsets (uint64_t) and a footer:
+ *   num_edges, block_size, num_blocks (int64_t), magic string "DGCBIN01"
+ * Putting the index at the end allows the file to be written out in a single pass.
+ */
+
+static const int64_t cbin_default_block_size = 64 * 1024;
+
+// Appends the encoded form of the edges in [begin, end) to out
+void encode_edge_block(const Edge* begin, const Edge* end, std::vector<uint8_t>& out);
+
+// Decodes num_edges edges from the block in [begin, end)
+// Returns false if the block is truncated or malformed
+bool decode_edge_block(const uint8_t* begin, const uint8_t* end, int64_t num_edges, Edge* out);
+
+// Writes edges to a .graph.cbin file, one block at a time
+class CompressedEdgeWriter
+{
+private:
+    FILE* fp;
+    int64_t block_size;
+    int64_t num_edges;
+    // Edges that don't yet fill up a complete block
+    std::vector<Edge> pending;
+    // Byte offset of the start of each block
+    std::vector<uint64_t> offsets;
+
+    // Encode the pending edges (in parallel) and write out the first num_blocks blocks
+    void flushBlocks(int64_t num_blocks);
+
+public:
+    CompressedEdgeWriter(FILE* fp, int64_t block_size = cbin_default_block_size);
+    // Encode and write out edges, complete blocks are flushed immediately
+    void write(const Edge* begin, const Edge* end);
+    // Flush the last partial block and write out the index
+    void finish();
+};
+
+// Load all the edges from a .graph.cbin file, decoding blocks in parallel
+void read_compressed_edges(const std::string& path, pvector<Edge>& edges);
+
+} // end namespace DynoGraph
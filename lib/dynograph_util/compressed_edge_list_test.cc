@@ -0,0 +1,90 @@
+#include "compressed_edge_list.h"
+#include "edgelist_dataset.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace DynoGraph;
+
+// Make sure a single block survives a round trip, including negative and large values
+TEST(CompressedEdgeListTest, EncodeDecodeBlock) {
+    std::vector<Edge> edges = {
+        {1, 2, 1, -100},
+        {2, 3, 1, 200},
+        {3, 4, -7, 200},
+        {INT64_MAX, 0, -7, 300},
+        {5, INT64_MAX, 1, INT64_MAX},
+    };
+    std::vector<uint8_t> encoded;
+    encode_edge_block(&edges[0], &edges[0] + edges.size(), encoded);
+
+    std::vector<Edge> decoded(edges.size());
+    ASSERT_TRUE(decode_edge_block(encoded.data(), encoded.data() + encoded.size(), edges.size(), &decoded[0]));
+    ASSERT_EQ(edges, decoded);
+
+    // A truncated block should be rejected
+    ASSERT_FALSE(decode_edge_block(encoded.data(), encoded.data() + encoded.size() - 1, edges.size(), &decoded[0]));
+}
+
+// Make sure a file written in several pieces can be read back
+TEST(CompressedEdgeListTest, WriteAndReadFile) {
+    std::mt19937_64 rng(1234);
+    std::uniform_int_distribution<int64_t> vertex(0, 1000000);
+    std::uniform_int_distribution<int64_t> gap(0, 3);
+    std::vector<Edge> edges(10000);
+    int64_t timestamp = 0;
+    for (Edge& e : edges) {
+        timestamp += gap(rng);
+        e = {vertex(rng), vertex(rng), gap(rng) == 0 ? 2 : 1, timestamp};
+    }
+
+    std::string temp_filename = "test_edges.graph.cbin";
+    for (int64_t block_size : {1, 7, 1000, 100000}) {
+        FILE* fp = fopen(temp_filename.c_str(), "wb");
+        CompressedEdgeWriter writer(fp, block_size);
+        // Write in uneven chunks to exercise partial blocks
+        for (size_t i = 0; i < edges.size(); i += 333) {
+            size_t end = std::min(edges.size(), i + 333);
+            writer.write(&edges[i], &edges[0] + end);
+        }
+        writer.finish();
+        fclose(fp);
+
+        pvector<Edge> loaded;
+        read_compressed_edges(temp_filename, loaded);
+        ASSERT_EQ(edges.size(), loaded.size());
+        ASSERT_TRUE(std::equal(edges.begin(), edges.end(), loaded.begin()));
+    }
+    remove(temp_filename.c_str());
+}
+
+// Make sure a compressed dataset loads the same as the original
+TEST(CompressedEdgeListTest, LoadDataset) {
+    Args args = {};
+    args.input_path = "data/worldcup-10K.graph.bin";
+    args.num_epochs = 1;
+    args.batch_size = 1000;
+    args.window_size = 1.0;
+    args.num_trials = 1;
+    args.num_alg_trials = 1;
+    EdgeListDataset expected(args);
+
+    // Convert the dataset to compressed format
+    std::string temp_filename = "test_worldcup.graph.cbin";
+    auto all_edges = expected.getBatchesUpTo(expected.getNumBatches() - 1);
+    FILE* fp = fopen(temp_filename.c_str(), "wb");
+    CompressedEdgeWriter writer(fp);
+    writer.write(all_edges->begin(), all_edges->end());
+    writer.finish();
+    fclose(fp);
+
+    args.input_path = temp_filename;
+    EdgeListDataset actual(args);
+    ASSERT_EQ(expected.getNumBatches(), actual.getNumBatches());
+    ASSERT_EQ(expected.getMaxVertexId(), actual.getMaxVertexId());
+    for (int64_t i = 0; i < expected.getNumBatches(); ++i) {
+        auto a = expected.getBatch(i);
+        auto b = actual.getBatch(i);
+        ASSERT_TRUE(std::equal(a->begin(), a->end(), b->begin()));
+    }
+    remove(temp_filename.c_str());
+}
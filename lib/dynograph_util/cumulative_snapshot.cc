@@ -0,0 +1,336 @@
+#include "cumulative_snapshot.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+static int num_threads() { return omp_get_max_threads(); }
+#else
+static int num_threads() { return 1; }
+#endif
+
+using namespace DynoGraph;
+using std::shared_ptr;
+using std::make_shared;
+
+// Order by src ascending, then dest ascending
+static bool
+by_src_dest(const Edge& a, const Edge& b)
+{
+    return (a.src != b.src) ? a.src < b.src : a.dst < b.dst;
+}
+
+static bool
+same_src_dest(const Edge& a, const Edge& b)
+{
+    return a.src == b.src && a.dst == b.dst;
+}
+
+// Sorts a batch by src and dest, and combines duplicate edges
+static void
+sort_and_dedup(Batch& batch)
+{
+    std::sort(batch.begin(), batch.end(), by_src_dest);
+    batch.dedup();
+}
+
+// Flags for each vertex, see needs_resort below
+static const uint8_t SRC_TOUCHED = 1;
+static const uint8_t DEGREE_CHANGED = 2;
+
+// Number of parts to split n elements into for a parallel pass
+static int64_t
+parts_for(int64_t n)
+{
+    return std::max<int64_t>(1, std::min<int64_t>(num_threads(), n / 1024));
+}
+
+// Picks split keys for merging two sorted ranges in num_parts independent pieces
+// The keys are evenly spaced elements of the longer range
+static void
+choose_split_keys(const Edge* a, int64_t na, const Edge* b, int64_t nb, int64_t num_parts, pvector<Edge>& keys)
+{
+    const Edge* longer = na >= nb ? a : b;
+    const int64_t n = std::max(na, nb);
+    keys.resize(num_parts - 1);
+    for (int64_t p = 1; p < num_parts; ++p) {
+        keys[p - 1] = longer[p * n / num_parts];
+    }
+}
+
+// Finds where each part begins in a sorted range
+// Elements equal to a split key go in the later part, so merging the parts in order is the same as one merge
+template<typename Compare>
+static void
+find_splits(const Edge* range, int64_t n, const pvector<Edge>& keys, Compare comp, pvector<int64_t>& splits)
+{
+    const int64_t num_parts = keys.size() + 1;
+    splits.resize(num_parts + 1);
+    splits[0] = 0;
+    splits[num_parts] = n;
+    for (int64_t p = 1; p < num_parts; ++p) {
+        splits[p] = std::lower_bound(range, range + n, keys[p - 1], comp) - range;
+    }
+}
+
+// Copies the edges that satisfy pred into out, preserving their order
+template<typename Predicate>
+static void
+copy_if_parallel(const Edge* in, int64_t n, pvector<Edge>& out, Predicate pred)
+{
+    const int64_t num_parts = parts_for(n);
+    const int64_t part_size = (n + num_parts - 1) / num_parts;
+    pvector<int64_t> part_offsets(num_parts + 1);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        int64_t count = 0;
+        for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+            if (pred(in[i])) { count += 1; }
+        }
+        part_offsets[p + 1] = count;
+    }
+    part_offsets[0] = 0;
+    for (int64_t p = 0; p < num_parts; ++p) {
+        part_offsets[p + 1] += part_offsets[p];
+    }
+
+    out.clear();
+    out.resize(part_offsets[num_parts]);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        Edge* pos = out.begin() + part_offsets[p];
+        for (int64_t i = p * part_size; i < std::min(n, (p + 1) * part_size); ++i) {
+            if (pred(in[i])) { *pos++ = in[i]; }
+        }
+    }
+}
+
+// Merges two sorted ranges into out, splitting the work into independent parts
+template<typename Compare>
+static void
+merge_parallel(const pvector<Edge>& a, const pvector<Edge>& b, pvector<Edge>& out, Compare comp)
+{
+    const int64_t na = a.size(), nb = b.size();
+    const int64_t num_parts = parts_for(na + nb);
+    pvector<Edge> keys;
+    pvector<int64_t> a_splits, b_splits;
+    choose_split_keys(a.begin(), na, b.begin(), nb, num_parts, keys);
+    find_splits(a.begin(), na, keys, comp, a_splits);
+    find_splits(b.begin(), nb, keys, comp, b_splits);
+
+    out.clear();
+    out.resize(na + nb);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        std::merge(a.begin() + a_splits[p], a.begin() + a_splits[p + 1],
+                   b.begin() + b_splits[p], b.begin() + b_splits[p + 1],
+                   out.begin() + a_splits[p] + b_splits[p], comp);
+    }
+}
+
+CumulativeSnapshot::CumulativeSnapshot()
+: last_batch_id(-1)
+{}
+
+void
+CumulativeSnapshot::reset()
+{
+    history.clear();
+    edges.clear();
+    ordered.clear();
+    degree.clear();
+    flags.clear();
+    last_batch_id = -1;
+}
+
+shared_ptr<Batch>
+CumulativeSnapshot::update(int64_t batchId, IDataset &dataset)
+{
+    // Going backwards requires starting over
+    if (batchId <= last_batch_id) { reset(); }
+
+    int64_t threshold = dataset.getTimestampForWindow(batchId);
+
+    // Collect the edges that were added since the last update
+    pvector<Edge> delta_edges;
+    if (last_batch_id < 0) {
+        shared_ptr<Batch> batch = dataset.getBatchesUpTo(batchId);
+        delta_edges.resize(batch->size());
+        std::copy(batch->begin(), batch->end(), delta_edges.begin());
+    } else {
+        std::vector<shared_ptr<Batch>> new_batches;
+        size_t num_new_edges = 0;
+        for (int64_t i = last_batch_id + 1; i <= batchId; ++i) {
+            new_batches.push_back(dataset.getBatch(i));
+            num_new_edges += new_batches.back()->size();
+        }
+        delta_edges.resize(num_new_edges);
+        Edge* pos = delta_edges.begin();
+        for (const shared_ptr<Batch>& batch : new_batches) {
+            pos = std::copy(batch->begin(), batch->end(), pos);
+        }
+    }
+    last_batch_id = batchId;
+    Batch added(delta_edges.begin(), delta_edges.end());
+    added.filter(threshold);
+
+    // Pull out the edges that have fallen out of the window, and append the new ones
+    auto expired_end = std::lower_bound(history.begin(), history.end(), threshold,
+        [](const Edge& e, int64_t t) { return e.timestamp < t; });
+    pvector<Edge> expired_edges(expired_end - history.begin());
+    std::copy(history.begin(), expired_end, expired_edges.begin());
+    history.erase(history.begin(), expired_end);
+    history.insert(history.end(), added.begin(), added.end());
+    Batch expired(expired_edges.begin(), expired_edges.end());
+
+    // Combine duplicates within the delta, so they can be merged into the deduplicated window
+    sort_and_dedup(added);
+    sort_and_dedup(expired);
+
+    // Merge the new edges into the window and subtract the weight of the expired ones
+    // An edge leaves the window once its most recent occurrence has expired
+    // The key space is split into parts, and each part of the three lists is merged independently
+    const int64_t num_parts = parts_for(edges.size() + added.size());
+    pvector<Edge> keys;
+    pvector<int64_t> w_splits, a_splits, x_splits;
+    choose_split_keys(edges.begin(), edges.size(), added.begin(), added.size(), num_parts, keys);
+    find_splits(edges.begin(), edges.size(), keys, by_src_dest, w_splits);
+    find_splits(added.begin(), added.size(), keys, by_src_dest, a_splits);
+    find_splits(expired.begin(), expired.size(), keys, by_src_dest, x_splits);
+
+    merged.clear();
+    merged.resize(edges.size() + added.size());
+    pvector<int64_t> part_offsets(num_parts + 1);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        Edge* out_begin = merged.begin() + w_splits[p] + a_splits[p];
+        Edge* out = out_begin;
+        const Edge* w = edges.begin() + w_splits[p];
+        const Edge* w_end = edges.begin() + w_splits[p + 1];
+        const Edge* a = added.begin() + a_splits[p];
+        const Edge* a_end = added.begin() + a_splits[p + 1];
+        const Edge* x = expired.begin() + x_splits[p];
+        const Edge* x_end = expired.begin() + x_splits[p + 1];
+        while (w != w_end || a != a_end) {
+            Edge e;
+            if (a == a_end || (w != w_end && by_src_dest(*w, *a))) {
+                e = *w++;
+            } else if (w == w_end || by_src_dest(*a, *w)) {
+                e = *a++;
+            } else {
+                e = *w++;
+                e.weight += a->weight;
+                e.timestamp = std::max(e.timestamp, a->timestamp);
+                ++a;
+            }
+            while (x != x_end && by_src_dest(*x, e)) { ++x; }
+            if (x != x_end && same_src_dest(*x, e)) {
+                e.weight -= x->weight;
+                ++x;
+            }
+            if (e.timestamp >= threshold) { *out++ = e; }
+        }
+        part_offsets[p + 1] = out - out_begin;
+    }
+    part_offsets[0] = 0;
+    for (int64_t p = 0; p < num_parts; ++p) {
+        part_offsets[p + 1] += part_offsets[p];
+    }
+
+    // Pack the parts together
+    edges.clear();
+    edges.resize(part_offsets[num_parts]);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < num_parts; ++p) {
+        const Edge* part_begin = merged.begin() + w_splits[p] + a_splits[p];
+        std::copy(part_begin, part_begin + (part_offsets[p + 1] - part_offsets[p]),
+                  edges.begin() + part_offsets[p]);
+    }
+
+    // Nothing to patch on the first update, sort the whole window
+    if (degree.size() == 0) {
+        const int64_t num_vertices = dataset.getMaxVertexId() + 1;
+        degree.resize(num_vertices);
+        degree.fill(0);
+        flags.resize(num_vertices);
+        flags.fill(0);
+        // The out degree of a vertex is the length of its run in the window
+        const int64_t n = edges.size();
+        const Edge* window = edges.begin();
+        #pragma omp parallel for schedule(static)
+        for (int64_t i = 0; i < n; ++i) {
+            if (i > 0 && window[i-1].src == window[i].src) { continue; }
+            int64_t j = i + 1;
+            while (j < n && window[j].src == window[i].src) { ++j; }
+            degree[window[i].src] = j - i;
+        }
+        ordered = edges;
+        Batch(ordered.begin(), ordered.end()).sort_by_out_degree();
+        return make_shared<ConcreteBatch>(Batch(ordered.begin(), ordered.end()));
+    }
+
+    // Only the sources of added or expired edges can have a different out degree
+    touched.clear();
+    touched.resize(added.size() + expired.size());
+    int64_t* touched_end = touched.begin();
+    for (const Edge* e = added.begin(); e != added.end(); ++e) {
+        if (e == added.begin() || (e-1)->src != e->src) { *touched_end++ = e->src; }
+    }
+    int64_t* added_srcs_end = touched_end;
+    for (const Edge* e = expired.begin(); e != expired.end(); ++e) {
+        if (e == expired.begin() || (e-1)->src != e->src) { *touched_end++ = e->src; }
+    }
+    std::inplace_merge(touched.begin(), added_srcs_end, touched_end);
+    touched.resize(std::unique(touched.begin(), touched_end) - touched.begin());
+
+    // Look up the new out degree of each touched vertex in the window
+    const int64_t num_touched = touched.size();
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < num_touched; ++i) {
+        int64_t v = touched[i];
+        const Edge* run_begin = std::lower_bound(edges.begin(), edges.end(), v,
+            [](const Edge& e, int64_t v) { return e.src < v; });
+        const Edge* run_end = std::upper_bound(run_begin, (const Edge*)edges.end(), v,
+            [](int64_t v, const Edge& e) { return v < e.src; });
+        uint8_t f = SRC_TOUCHED;
+        if (run_end - run_begin != degree[v]) {
+            degree[v] = run_end - run_begin;
+            f |= DEGREE_CHANGED;
+        }
+        flags[v] = f;
+    }
+
+    // An edge moves in the ordering if the degree of either endpoint changed,
+    // or if it was added, expired or changed weight. The rest stay in the same relative order.
+    // Only the edges of touched vertices need to be looked up in the delta.
+    auto needs_resort = [&](const Edge& e) {
+        uint8_t src_flags = flags[e.src];
+        if ((src_flags | flags[e.dst]) & DEGREE_CHANGED) { return true; }
+        if (!(src_flags & SRC_TOUCHED)) { return false; }
+        return std::binary_search(added.begin(), added.end(), e, by_src_dest)
+            || std::binary_search(expired.begin(), expired.end(), e, by_src_dest);
+    };
+    // Out degree descending, then src and dst, same as sort_by_out_degree
+    auto by_degree = [this](const Edge& a, const Edge& b) {
+        int64_t a_src = degree[a.src], b_src = degree[b.src];
+        if (a_src != b_src) { return a_src > b_src; }
+        int64_t a_dst = degree[a.dst], b_dst = degree[b.dst];
+        if (a_dst != b_dst) { return a_dst > b_dst; }
+        return by_src_dest(a, b);
+    };
+
+    copy_if_parallel(edges.begin(), edges.size(), moved, needs_resort);
+    std::sort(moved.begin(), moved.end(), by_degree);
+    copy_if_parallel(ordered.begin(), ordered.size(), merged,
+        [&](const Edge& e) { return !needs_resort(e); });
+    merge_parallel(merged, moved, ordered, by_degree);
+
+    // Clear the flags for the next update
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < num_touched; ++i) {
+        flags[touched[i]] = 0;
+    }
+
+    // Return a copy of the snapshot, ordered by degree
+    return make_shared<ConcreteBatch>(Batch(ordered.begin(), ordered.end()));
+}
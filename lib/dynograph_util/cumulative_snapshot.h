@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include "batch.h"
+#include "idataset.h"
+#include "pvector.h"
+
+namespace DynoGraph {
+
+// Maintains a filtered, deduplicated snapshot of all the edges up to the current batch
+// Instead of rebuilding the snapshot from scratch each epoch, only the batches added since the
+// previous update are deduplicated and merged in, and edges that have fallen out of the window are taken out.
+// The degree ordering is patched by re-sorting only the edges whose key changed.
+class CumulativeSnapshot
+{
+private:
+    // Edges within the window as they arrived, in timestamp order
+    // Used to find out which weights to subtract when edges expire. This can't be recovered from
+    // the deduplicated edges, which only keep the summed weight and the most recent timestamp, and
+    // re-reading the expired batches from the dataset isn't cheap (the R-MAT generator starts over from
+    // the beginning, the streaming dataset goes back to disk). Rebuilding the snapshot from scratch
+    // each epoch copied the whole raw window too, plus scratch space to sort it.
+    std::deque<Edge> history;
+    // Deduplicated edges within the window, sorted by src and dst
+    pvector<Edge> edges;
+    // The same edges, sorted by out degree
+    pvector<Edge> ordered;
+    // Out degree of each vertex within the window, indexed by vertex ID
+    pvector<int64_t> degree;
+    // Per-vertex flags for the current update, indexed by vertex ID
+    // Only the entries for the vertices in touched are ever set
+    pvector<uint8_t> flags;
+    // Sources of the edges that were added or expired in the current update, sorted
+    pvector<int64_t> touched;
+    // Scratch space for merging
+    pvector<Edge> merged;
+    pvector<Edge> moved;
+    // Last batch merged into the snapshot, or -1 if empty
+    int64_t last_batch_id;
+
+public:
+    CumulativeSnapshot();
+    // Returns the cumulative snapshot up to batchId, sorted by out degree
+    // Equivalent to filtering getBatchesUpTo(batchId) and calling dedup_and_sort_by_out_degree()
+    std::shared_ptr<Batch> update(int64_t batchId, IDataset &dataset);
+    // Discard the snapshot, the next update will start from the beginning
+    void reset();
+};
+
+} // end namespace DynoGraph
@@ -4,6 +4,7 @@
 #include "batch.h"
 #include <vector>
 #include <string>
+#include <algorithm>
 
 namespace DynoGraph {
 
@@ -60,6 +61,53 @@ operator < (const vertex_degree &a, const vertex_degree &b) {
     return a.vertex_id > b.vertex_id;
 }
 
+// Returns the n vertices with the highest out degree, in order of increasing degree
+// get_degree(v) is called once for each vertex in [0, nv)
+// Each thread keeps a min-heap of its n best candidates, avoiding a full sort of all nv vertices
+template<typename DegreeGetter>
+std::vector<int64_t>
+top_k_vertices(int64_t n, int64_t nv, DegreeGetter get_degree)
+{
+    std::vector<vertex_degree> candidates;
+    if (n <= 0) { return std::vector<int64_t>(); }
+
+    // Heap comparator that keeps the lowest degree vertex at the front
+    auto higher = [](const vertex_degree &a, const vertex_degree &b) { return b < a; };
+    #pragma omp parallel
+    {
+        std::vector<vertex_degree> heap;
+        heap.reserve(n);
+        #pragma omp for nowait
+        for (int64_t v = 0; v < nv; ++v) {
+            vertex_degree d(v, get_degree(v));
+            if (static_cast<int64_t>(heap.size()) < n) {
+                heap.push_back(d);
+                std::push_heap(heap.begin(), heap.end(), higher);
+            } else if (heap.front() < d) {
+                std::pop_heap(heap.begin(), heap.end(), higher);
+                heap.back() = d;
+                std::push_heap(heap.begin(), heap.end(), higher);
+            }
+        }
+        #pragma omp critical
+        candidates.insert(candidates.end(), heap.begin(), heap.end());
+    }
+
+    // Pick the top n among each thread's candidates
+    if (static_cast<int64_t>(candidates.size()) > n) {
+        auto first = candidates.begin() + (candidates.size() - n);
+        std::nth_element(candidates.begin(), first, candidates.end());
+        candidates.erase(candidates.begin(), first);
+    }
+    // order by degree ascending, vertex_id descending
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<int64_t> ids(candidates.size());
+    std::transform(candidates.begin(), candidates.end(), ids.begin(),
+        [](const vertex_degree &d) { return d.vertex_id; });
+    return ids;
+}
+
 #ifdef USE_MPI
 BOOST_IS_BITWISE_SERIALIZABLE(DynoGraph::vertex_degree);
 #endif
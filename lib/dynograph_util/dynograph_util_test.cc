@@ -3,10 +3,12 @@
 
 #include "reference_impl.h"
 #include "edgelist_dataset.h"
+#include "streaming_dataset.h"
 #include "benchmark.h"
 #include <gtest/gtest.h>
 #include "pvector.h"
 #include <fstream>
+#include <unistd.h>
 #include <iostream>
 
 using namespace DynoGraph;
@@ -35,6 +37,84 @@ TEST(DynoGraphUtilTests, LoadSources) {
     remove(temp_filename.c_str());
 }
 
+// Make sure every trial in an epoch starts with the data from the end of the previous epoch
+TEST(DynoGraphUtilTests, AlgDataRollback) {
+    const int64_t nv = 10;
+    const int64_t num_alg_trials = 3;
+    AlgDataManager manager(nv, {"bfs"}, num_alg_trials);
+    for (int64_t epoch = 0; epoch < 3; ++epoch) {
+        for (int64_t trial = 0; trial < num_alg_trials; ++trial) {
+            manager.begin_trial(trial);
+            Range<int64_t> data = manager.get_data_for_alg("bfs");
+            for (int64_t v = 0; v < nv; ++v) {
+                // Each trial should see the result of the last trial of the previous epoch
+                if (epoch > 0) { ASSERT_EQ(data[v], (epoch - 1) * 100 + (num_alg_trials - 1)); }
+                data[v] = epoch * 100 + trial;
+            }
+        }
+    }
+}
+
+// Make sure alg data dumps can be read back for every epoch
+// The manager lives across trials, and the files from the last trial should win
+TEST(DynoGraphUtilTests, AlgDataDump) {
+    char temp_dir[] = "alg_data_XXXXXX";
+    ASSERT_NE(mkdtemp(temp_dir), nullptr);
+    setenv("DYNOGRAPH_ALG_DATA_PATH", temp_dir, 1);
+
+    const int64_t nv = 1000;
+    const int64_t num_epochs = 4;
+    const int64_t num_trials = 2;
+    std::vector<std::vector<int64_t>> expected(num_epochs);
+    {
+        AlgDataManager manager(nv, {"cc"});
+        Range<int64_t> data = manager.get_data_for_alg("cc");
+        for (int64_t trial = 0; trial < num_trials; ++trial) {
+            for (int64_t epoch = 0; epoch < num_epochs; ++epoch) {
+                manager.begin_trial(0);
+                // Change a different subset of vertices each epoch
+                for (int64_t v = 0; v < nv; v += epoch + trial + 1) { data[v] = v * 10 + epoch - 3 + trial * 7; }
+                expected[epoch] = std::vector<int64_t>(data.begin(), data.end());
+                manager.dump(epoch);
+            }
+        }
+        // Destroying the manager waits for writes to finish
+    }
+    unsetenv("DYNOGRAPH_ALG_DATA_PATH");
+
+    for (int64_t epoch = 0; epoch < num_epochs; ++epoch) {
+        pvector<int64_t> actual = read_alg_data(temp_dir, "cc", epoch);
+        ASSERT_EQ(expected[epoch].size(), actual.size());
+        ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected[epoch].begin()));
+    }
+
+    // Clean up
+    for (int64_t epoch = 0; epoch < num_epochs; ++epoch) {
+        std::string epoch_dir = std::string(temp_dir) + "/" + std::to_string(epoch);
+        remove((epoch_dir + "/cc.delta").c_str());
+        rmdir(epoch_dir.c_str());
+    }
+    rmdir(temp_dir);
+}
+
+// Make sure top-k selection matches a full sort, including ties
+TEST(DynoGraphUtilTests, TopKVertices) {
+    const int64_t nv = 10000;
+    std::vector<int64_t> degrees(nv);
+    for (int64_t v = 0; v < nv; ++v) { degrees[v] = (v * 7919) % 97; }
+
+    std::vector<vertex_degree> sorted(nv);
+    for (int64_t v = 0; v < nv; ++v) { sorted[v] = vertex_degree(v, degrees[v]); }
+    std::sort(sorted.begin(), sorted.end());
+
+    for (int64_t n : {0, 1, 64, 128, 5000}) {
+        std::vector<int64_t> expected;
+        for (int64_t i = nv - n; i < nv; ++i) { expected.push_back(sorted[i].vertex_id); }
+        std::vector<int64_t> actual = top_k_vertices(n, nv, [&degrees](int64_t v) { return degrees[v]; });
+        ASSERT_EQ(expected, actual);
+    }
+}
+
 class DatasetTest: public ::testing::TestWithParam<Args> {
 public:
     static std::vector<Args> all_args;
@@ -45,6 +125,7 @@ public:
         args.num_trials = 1;
         args.sort_mode = Args::SORT_MODE::UNSORTED;
         args.alg_names = {};
+        args.stream_window = 0;
 
         for (std::string input_path : { "data/worldcup-10K.graph.bin", "0.55-0.20-0.10-0.15-44500-8K.rmat" }) {
             args.input_path = input_path;
@@ -122,6 +203,7 @@ public:
         args.num_epochs = 1;
         args.num_trials = 1;
         args.alg_names = {};
+        args.stream_window = 0;
 
         for (int64_t batch_size : { 100, 500, 5000 }) {
             args.batch_size = batch_size;
@@ -209,8 +291,69 @@ TEST_P(SortModeTest, SortModeDoesntAffectEdgeCount)
     }
 }
 
+TEST_P(SortModeTest, IncrementalSnapshotMatchesRebuild)
+{
+    DynoGraph::Args args = GetParam();
+    DynoGraph::EdgeListDataset dataset(args);
+    CumulativeSnapshot snapshot;
+
+    // Skip some batches, like we do between epochs
+    for (int64_t batch = 0; batch < dataset.getNumBatches(); batch += 3)
+    {
+        auto expected = get_preprocessed_batch(batch, dataset, Args::SORT_MODE::SNAPSHOT);
+        auto actual = get_preprocessed_batch(batch, dataset, Args::SORT_MODE::SNAPSHOT, &snapshot);
+        ASSERT_EQ(expected->size(), actual->size());
+        // Should match exactly, including the degree ordering
+        ASSERT_TRUE(std::equal(expected->begin(), expected->end(), actual->begin()));
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(SortModeDoesntAffectEdgeCount, SortModeTest, ::testing::ValuesIn(SortModeTest::all_args));
 
+// Make sure streaming batches from disk gives the same results as loading the whole file
+TEST(DynoGraphUtilTests, StreamingDatasetMatchesEdgeListDataset) {
+    Args args = {};
+    args.input_path = "data/worldcup-10K.graph.bin";
+    args.num_epochs = 1;
+    args.num_trials = 1;
+    args.num_alg_trials = 1;
+    args.window_size = 0.5;
+    args.stream_window = 3;
+
+    for (int64_t batch_size : { 100, 5000 }) {
+        args.batch_size = batch_size;
+        EdgeListDataset expected(args);
+        StreamingDataset actual(args);
+
+        ASSERT_EQ(expected.getNumEdges(), actual.getNumEdges());
+        ASSERT_EQ(expected.getNumBatches(), actual.getNumBatches());
+        ASSERT_EQ(expected.getMaxVertexId(), actual.getMaxVertexId());
+        ASSERT_EQ(expected.getMinTimestamp(), actual.getMinTimestamp());
+        ASSERT_EQ(expected.getMaxTimestamp(), actual.getMaxTimestamp());
+
+        // Run through the dataset twice to check that reset() works
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int64_t i = 0; i < expected.getNumBatches(); ++i) {
+                int64_t threshold = expected.getTimestampForWindow(i);
+                ASSERT_EQ(threshold, actual.getTimestampForWindow(i));
+
+                auto expected_batch = expected.getBatch(i);
+                auto actual_batch = actual.getBatch(i);
+                ASSERT_TRUE(std::equal(expected_batch->begin(), expected_batch->end(), actual_batch->begin()));
+
+                // Streaming dataset may skip old batches, but the filtered edges must be the same
+                auto expected_window = expected.getBatchesUpTo(i);
+                auto actual_window = actual.getBatchesUpTo(i);
+                expected_window->filter(threshold);
+                actual_window->filter(threshold);
+                ASSERT_EQ(expected_window->size(), actual_window->size());
+                ASSERT_TRUE(std::equal(expected_window->begin(), expected_window->end(), actual_window->begin()));
+            }
+            actual.reset();
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
 #ifdef USE_MPI
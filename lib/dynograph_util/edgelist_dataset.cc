@@ -5,6 +5,7 @@
 #include "edgelist_dataset.h"
 #include "helpers.h"
 #include "logger.h"
+#include "compressed_edge_list.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,6 +26,8 @@ EdgeListDataset::EdgeListDataset(Args args)
         loadEdgesBinary(args.input_path);
     } else if (has_suffix(args.input_path, ".graph.el")) {
         loadEdgesAscii(args.input_path);
+    } else if (has_suffix(args.input_path, ".graph.cbin")) {
+        loadEdgesCompressed(args.input_path);
     } else {
         logger << "Unrecognized file extension for " << args.input_path << "\n";
         die();
@@ -158,6 +161,18 @@ EdgeListDataset::loadEdgesAscii(string path)
     fclose(fp);
 }
 
+void
+EdgeListDataset::loadEdgesCompressed(string path)
+{
+    Logger &logger = Logger::get_instance();
+    string directedStr = directed ? "directed" : "undirected";
+    logger << "Preloading "
+           << directedStr
+           << " edges from compressed edge list " << path << "...\n";
+
+    read_compressed_edges(path, edges);
+}
+
 int64_t
 EdgeListDataset::getTimestampForWindow(int64_t batchId) const
 {
@@ -0,0 +1,340 @@
+#include "binary_output.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using json = nlohmann::json;
+using std::cerr;
+using std::string;
+using std::vector;
+
+namespace hooks_binary {
+
+RingBuffer::RingBuffer(size_t capacity)
+: buffer(capacity)
+, head(0)
+, tail(0)
+{}
+
+size_t
+RingBuffer::push(const char* data, size_t size)
+{
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    const uint64_t t = tail.load(std::memory_order_acquire);
+    size = std::min(size, buffer.size() - static_cast<size_t>(h - t));
+    if (size == 0) { return 0; }
+    const size_t offset = h % buffer.size();
+    const size_t first = std::min(size, buffer.size() - offset);
+    memcpy(&buffer[offset], data, first);
+    memcpy(&buffer[0], data + first, size - first);
+    head.store(h + size, std::memory_order_release);
+    return size;
+}
+
+BinaryWriter::BinaryWriter(const string& filename, size_t buffer_size)
+: fp(fopen(filename.c_str(), "ab"))
+, ring(buffer_size)
+, done(false)
+, num_stalls(0)
+{
+    if (fp == NULL) {
+        cerr << "ERROR: Unable to open " << filename << " for hooks output\n";
+        exit(-1);
+    }
+    if (buffer_size < min_buffer_size) {
+        cerr << "ERROR: Hooks output buffer must be at least " << min_buffer_size << " bytes\n";
+        exit(-1);
+    }
+    // Start draining before queueing anything, so records larger than the buffer don't wait forever
+    flush_thread = std::thread(&BinaryWriter::run, this);
+    put_record(FILE_HEADER, file_magic, sizeof(file_magic));
+}
+
+BinaryWriter::~BinaryWriter()
+{
+    done.store(true, std::memory_order_release);
+    flush_thread.join();
+    fclose(fp);
+    if (num_stalls > 0) {
+        cerr << "WARNING: Hooks output stalled " << num_stalls << " times waiting for the disk, "
+             << "increase HOOKS_BUFFER_SIZE\n";
+    }
+}
+
+void
+BinaryWriter::run()
+{
+    bool ok = true;
+    auto write_bytes = [this, &ok](const char* data, size_t size) {
+        if (fwrite(data, 1, size, fp) != size) { ok = false; }
+    };
+    while (true)
+    {
+        // Check for exit before draining, so everything queued before the destructor is written
+        bool exiting = done.load(std::memory_order_acquire);
+        if (ring.pop(write_bytes) > 0) {
+            if (fflush(fp) != 0) { ok = false; }
+            // Records after a short write can't be decoded, so don't keep going
+            if (!ok) {
+                cerr << "ERROR: Failed to write hooks output\n";
+                exit(-1);
+            }
+        } else if (exiting) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+template<typename T>
+void
+BinaryWriter::put(vector<char>& out, const T& value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void
+BinaryWriter::push(const char* data, size_t size)
+{
+    // Wait for the background thread to make room if the buffer is full
+    bool stalled = false;
+    while (size > 0) {
+        size_t n = ring.push(data, size);
+        data += n;
+        size -= n;
+        if (n == 0) {
+            stalled = true;
+            std::this_thread::yield();
+        }
+    }
+    if (stalled) { ++num_stalls; }
+}
+
+void
+BinaryWriter::put_record(RecordType type, const char* data, size_t size)
+{
+    RecordHeader header = {type, static_cast<uint32_t>(size)};
+    push(reinterpret_cast<const char*>(&header), sizeof(header));
+    push(data, size);
+}
+
+uint32_t
+BinaryWriter::intern(const string& str)
+{
+    auto it = string_ids.find(str);
+    if (it != string_ids.end()) { return it->second; }
+
+    // Define the string before the record that uses it
+    uint32_t id = string_ids.size();
+    string_ids[str] = id;
+    vector<char> bytes;
+    put(bytes, id);
+    bytes.insert(bytes.end(), str.begin(), str.end());
+    put_record(STRING, bytes.data(), bytes.size());
+    return id;
+}
+
+void
+BinaryWriter::encode(const json& value)
+{
+    switch (value.type())
+    {
+        case json::value_t::null:
+            put(record, NULL_VALUE);
+            break;
+        case json::value_t::boolean:
+            put(record, BOOL);
+            put(record, static_cast<uint8_t>(value.get<bool>()));
+            break;
+        case json::value_t::number_integer:
+            put(record, INT);
+            put(record, value.get<int64_t>());
+            break;
+        case json::value_t::number_unsigned:
+            put(record, UINT);
+            put(record, value.get<uint64_t>());
+            break;
+        case json::value_t::number_float:
+            put(record, FLOAT);
+            put(record, value.get<double>());
+            break;
+        case json::value_t::string:
+            put(record, STRING_ID);
+            put(record, intern(value.get<string>()));
+            break;
+        case json::value_t::array: {
+            const uint32_t count = value.size();
+            // Per-thread counters and timers are stored as raw arrays
+            auto is_unsigned = [](const json& v) { return v.is_number_unsigned(); };
+            auto is_float = [](const json& v) { return v.is_number_float(); };
+            if (count > 0 && std::all_of(value.begin(), value.end(), is_unsigned)) {
+                put(record, UINT_ARRAY);
+                put(record, count);
+                for (const json& v : value) { put(record, v.get<uint64_t>()); }
+            } else if (count > 0 && std::all_of(value.begin(), value.end(), is_float)) {
+                put(record, FLOAT_ARRAY);
+                put(record, count);
+                for (const json& v : value) { put(record, v.get<double>()); }
+            } else {
+                put(record, ARRAY);
+                put(record, count);
+                for (const json& v : value) { encode(v); }
+            }
+            break;
+        }
+        case json::value_t::object: {
+            put(record, OBJECT);
+            put(record, static_cast<uint32_t>(value.size()));
+            for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+                put(record, intern(it.key()));
+                encode(it.value());
+            }
+            break;
+        }
+        default:
+            put(record, NULL_VALUE);
+            break;
+    }
+}
+
+void
+BinaryWriter::write(const json& results)
+{
+    record.clear();
+    encode(results);
+    put_record(REGION, record.data(), record.size());
+}
+
+// Reads values out of one record, checking bounds as it goes
+class RecordReader
+{
+private:
+    const char* pos;
+    const char* end;
+    const vector<string>& strings;
+public:
+    RecordReader(const vector<char>& bytes, const vector<string>& strings)
+    : pos(bytes.data()), end(bytes.data() + bytes.size()), strings(strings) {}
+
+    template<typename T>
+    bool get(T& value)
+    {
+        if (static_cast<size_t>(end - pos) < sizeof(T)) { return false; }
+        memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool get_string(string& str)
+    {
+        uint32_t id;
+        if (!get(id) || id >= strings.size()) { return false; }
+        str = strings[id];
+        return true;
+    }
+
+    bool decode(json& value)
+    {
+        uint8_t tag;
+        if (!get(tag)) { return false; }
+        switch (tag)
+        {
+            case NULL_VALUE: value = nullptr; return true;
+            case BOOL: { uint8_t v; if (!get(v)) { return false; } value = v != 0; return true; }
+            case INT: { int64_t v; if (!get(v)) { return false; } value = v; return true; }
+            case UINT: { uint64_t v; if (!get(v)) { return false; } value = v; return true; }
+            case FLOAT: { double v; if (!get(v)) { return false; } value = v; return true; }
+            case STRING_ID: { string v; if (!get_string(v)) { return false; } value = v; return true; }
+            case UINT_ARRAY: {
+                uint32_t count;
+                if (!get(count)) { return false; }
+                value = json::array();
+                for (uint32_t i = 0; i < count; ++i) {
+                    uint64_t v;
+                    if (!get(v)) { return false; }
+                    value.push_back(v);
+                }
+                return true;
+            }
+            case FLOAT_ARRAY: {
+                uint32_t count;
+                if (!get(count)) { return false; }
+                value = json::array();
+                for (uint32_t i = 0; i < count; ++i) {
+                    double v;
+                    if (!get(v)) { return false; }
+                    value.push_back(v);
+                }
+                return true;
+            }
+            case ARRAY: {
+                uint32_t count;
+                if (!get(count)) { return false; }
+                value = json::array();
+                for (uint32_t i = 0; i < count; ++i) {
+                    json v;
+                    if (!decode(v)) { return false; }
+                    value.push_back(v);
+                }
+                return true;
+            }
+            case OBJECT: {
+                uint32_t count;
+                if (!get(count)) { return false; }
+                value = json::object();
+                for (uint32_t i = 0; i < count; ++i) {
+                    string key;
+                    if (!get_string(key) || !decode(value[key])) { return false; }
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+};
+
+bool
+read_binary_output(FILE* fp, const std::function<void(json&)>& callback)
+{
+    vector<string> strings;
+    vector<char> bytes;
+    RecordHeader header;
+    while (fread(&header, sizeof(header), 1, fp) == 1)
+    {
+        bytes.resize(header.length);
+        if (fread(bytes.data(), 1, bytes.size(), fp) != bytes.size()) { return false; }
+        switch (header.type)
+        {
+            case FILE_HEADER:
+                if (bytes.size() != sizeof(file_magic) || memcmp(bytes.data(), file_magic, sizeof(file_magic)) != 0) {
+                    return false;
+                }
+                // Each run starts a new string table
+                strings.clear();
+                break;
+            case STRING: {
+                uint32_t id;
+                if (bytes.size() < sizeof(id)) { return false; }
+                memcpy(&id, bytes.data(), sizeof(id));
+                if (id != strings.size()) { return false; }
+                strings.emplace_back(bytes.begin() + sizeof(id), bytes.end());
+                break;
+            }
+            case REGION: {
+                json results;
+                RecordReader reader(bytes, strings);
+                if (!reader.decode(results)) { return false; }
+                callback(results);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return feof(fp) != 0;
+}
+
+} // end namespace hooks_binary
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "json.hpp"
+
+/*
+ * Binary hooks output
+ *
+ * A binary hooks file is a sequence of records, each starting with a fixed-size RecordHeader.
+ * Every run begins with a FILE_HEADER record holding the magic string "DGHOOKS1", so several runs can be
+ * appended to the same file. Strings (keys and string values) are interned: the first time a string is used,
+ * a STRING record defines its id, and later records refer to it by id. String ids restart with each run.
+ * A REGION record holds one object value, with the same contents as one line of the JSON output.
+ *
+ * Values are encoded as a one-byte tag followed by:
+ *   NULL_VALUE                  nothing
+ *   BOOL                        uint8_t
+ *   INT, UINT, FLOAT            int64_t, uint64_t, double
+ *   STRING_ID                   uint32_t string id
+ *   UINT_ARRAY, FLOAT_ARRAY     uint32_t count, then count uint64_t or double
+ *   ARRAY                       uint32_t count, then count values
+ *   OBJECT                      uint32_t count, then count (uint32_t key id, value) pairs
+ *
+ * Use read_binary_output() or the hooks_bin_to_json utility to convert back to JSON.
+ */
+namespace hooks_binary {
+
+enum RecordType : uint32_t { FILE_HEADER = 0, STRING = 1, REGION = 2 };
+
+enum ValueTag : uint8_t {
+    NULL_VALUE = 0, BOOL = 1, INT = 2, UINT = 3, FLOAT = 4, STRING_ID = 5,
+    ARRAY = 6, OBJECT = 7, UINT_ARRAY = 8, FLOAT_ARRAY = 9
+};
+
+struct RecordHeader
+{
+    uint32_t type;
+    // Number of bytes following the header
+    uint32_t length;
+};
+
+static const char file_magic[8] = {'D', 'G', 'H', 'O', 'O', 'K', 'S', '1'};
+
+// Smallest ring buffer BinaryWriter accepts, in bytes
+static const size_t min_buffer_size = 4096;
+
+// Single-producer, single-consumer byte queue that never blocks the consumer
+class RingBuffer
+{
+private:
+    std::vector<char> buffer;
+    // Total number of bytes ever written/read, the position in the buffer is this modulo the capacity
+    // Padded onto separate cache lines so the producer and consumer don't contend
+    // (not alignas, since operator new doesn't honor over-alignment before C++17)
+    std::atomic<uint64_t> head;
+    char head_padding[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> tail;
+    char tail_padding[64 - sizeof(std::atomic<uint64_t>)];
+public:
+    explicit RingBuffer(size_t capacity);
+    size_t capacity() const { return buffer.size(); }
+    // Copies as many bytes as will fit, returns the number copied
+    size_t push(const char* data, size_t size);
+    // Passes contiguous runs of queued bytes to the callback, then frees them; returns the number of bytes consumed
+    template<typename Callback>
+    size_t pop(Callback&& callback)
+    {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        const size_t size = h - t;
+        if (size == 0) { return 0; }
+        const size_t offset = t % buffer.size();
+        const size_t first = std::min(size, buffer.size() - offset);
+        callback(&buffer[offset], first);
+        if (first < size) { callback(&buffer[0], size - first); }
+        tail.store(h, std::memory_order_release);
+        return size;
+    }
+};
+
+// Encodes hooks results in binary and writes them to a file on a background thread
+class BinaryWriter
+{
+private:
+    FILE* fp;
+    RingBuffer ring;
+    std::atomic<bool> done;
+    std::thread flush_thread;
+    // Interned string ids
+    std::unordered_map<std::string, uint32_t> string_ids;
+    // Buffer for encoding the current record, reused to avoid allocations
+    std::vector<char> record;
+    // Number of times the producer had to wait for the background thread
+    int64_t num_stalls;
+
+    void run();
+    uint32_t intern(const std::string& str);
+    void encode(const nlohmann::json& value);
+    void push(const char* data, size_t size);
+    void put_record(RecordType type, const char* data, size_t size);
+    template<typename T> void put(std::vector<char>& out, const T& value);
+public:
+    // buffer_size is the size of the ring buffer in bytes, at least min_buffer_size
+    BinaryWriter(const std::string& filename, size_t buffer_size);
+    // Waits for all pending records to be written
+    ~BinaryWriter();
+    // Queue up a record, blocking only if the ring buffer is full
+    void write(const nlohmann::json& results);
+};
+
+// Decodes every REGION record in a binary hooks file, passing each to the callback
+// Returns false if the file is truncated or malformed
+bool read_binary_output(FILE* fp, const std::function<void(nlohmann::json&)>& callback);
+
+} // end namespace hooks_binary
@@ -5,6 +5,9 @@
  * For each file that does graph processing,
  * 1. Include this header ( and add this path to includes )
  * 2. Add DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE whenever an edge is traversed
+ *
+ * In inner loops, prefer counting into a local variable with the DYNOGRAPH_EDGE_COUNT_LOCAL_* macros,
+ * so the per-thread counter is only updated once per edge block.
  */
 
 #ifndef DYNOGRAPH_EDGE_COUNT_H
@@ -20,9 +23,18 @@ extern "C" {
 #endif
 
 
+#define DYNOGRAPH_EDGE_COUNT_CACHE_LINE_SIZE 64
+
+// Each thread's counter gets its own cache line, so threads don't invalidate each other's counters
+struct dynograph_edge_count_counter
+{
+    uint64_t num_traversed_edges;
+    char padding[DYNOGRAPH_EDGE_COUNT_CACHE_LINE_SIZE - sizeof(uint64_t)];
+};
+
 // Stores edge counts for each thread
 // Do not access directly, instead use macros below
-extern uint64_t* dynograph_edge_count_num_traversed_edges;
+extern struct dynograph_edge_count_counter* dynograph_edge_count_counters;
 
 #if defined(_OPENMP)
 #include <omp.h>
@@ -44,7 +56,7 @@ dynograph_edge_count_traverse_edges(int64_t n) {}
 static inline void
 dynograph_edge_count_traverse_edges(int64_t n)
 {
-    dynograph_edge_count_num_traversed_edges[DYNOGRAPH_EDGE_COUNT_THREAD_ID] += n;
+    dynograph_edge_count_counters[DYNOGRAPH_EDGE_COUNT_THREAD_ID].num_traversed_edges += n;
 }
 
 #endif // ENABLE_DYNOGRAPH_EDGE_COUNT
@@ -55,6 +67,17 @@ dynograph_edge_count_traverse_edges(1)
 #define DYNOGRAPH_EDGE_COUNT_TRAVERSE_MULTIPLE_EDGES(X) \
 dynograph_edge_count_traverse_edges(X)
 
+// Count edges in a local variable, then add them to this thread's counter with LOCAL_END
+// The counter is scoped to the enclosing block, so these can be nested
+#define DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN() \
+int64_t dynograph_edge_count_local__ = 0
+
+#define DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE() \
+(++dynograph_edge_count_local__)
+
+#define DYNOGRAPH_EDGE_COUNT_LOCAL_END() \
+dynograph_edge_count_traverse_edges(dynograph_edge_count_local__)
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,23 +1,27 @@
 #include "edge_count.h"
 #include <assert.h>
+#include <string.h>
 
 // Stores edge counts for each thread
-uint64_t* dynograph_edge_count_num_traversed_edges;
+struct dynograph_edge_count_counter* dynograph_edge_count_counters;
 
 // Must be called in main thread before any uses of TRAVERSE_EDGE or TRAVERSE_MULTIPLE_EDGES
 void
 dynograph_edge_count_init()
 {
-    assert(dynograph_edge_count_num_traversed_edges == NULL);
-    dynograph_edge_count_num_traversed_edges =
-        (uint64_t*)calloc(DYNOGRAPH_EDGE_COUNT_THREAD_COUNT, sizeof(uint64_t));
+    assert(dynograph_edge_count_counters == NULL);
+    size_t size = DYNOGRAPH_EDGE_COUNT_THREAD_COUNT * sizeof(struct dynograph_edge_count_counter);
+    void* counters = NULL;
+    if (posix_memalign(&counters, DYNOGRAPH_EDGE_COUNT_CACHE_LINE_SIZE, size) != 0) { return; }
+    memset(counters, 0, size);
+    dynograph_edge_count_counters = (struct dynograph_edge_count_counter*)counters;
 }
 
 // Can be used to check whether init has been called
 bool
 dynograph_edge_count_initialized()
 {
-    return dynograph_edge_count_num_traversed_edges != NULL;
+    return dynograph_edge_count_counters != NULL;
 }
 
 // Resets the edge counter for all threads to 0
@@ -25,7 +29,7 @@ void
 dynograph_edge_count_reset()
 {
     for (size_t i = 0; i < DYNOGRAPH_EDGE_COUNT_THREAD_COUNT; ++i) {
-        dynograph_edge_count_num_traversed_edges[i] = 0;
+        dynograph_edge_count_counters[i].num_traversed_edges = 0;
     }
 }
 
@@ -34,15 +38,15 @@ uint64_t
 dynograph_edge_count_get(size_t i)
 {
     assert(i < DYNOGRAPH_EDGE_COUNT_THREAD_COUNT);
-    return dynograph_edge_count_num_traversed_edges[i];
+    return dynograph_edge_count_counters[i].num_traversed_edges;
 }
 
 // Must be called after all uses of TRAVERSE_EDGE or TRAVERSE_MULTIPLE_EDGES
 void
 dynograph_edge_count_free() {
-    if (dynograph_edge_count_num_traversed_edges != NULL)
+    if (dynograph_edge_count_counters != NULL)
     {
-        free(dynograph_edge_count_num_traversed_edges);
-        dynograph_edge_count_num_traversed_edges = NULL;
+        free(dynograph_edge_count_counters);
+        dynograph_edge_count_counters = NULL;
     }
 }
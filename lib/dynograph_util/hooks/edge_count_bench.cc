@@ -0,0 +1,92 @@
+// Measures the overhead of the edge counting hooks on a simulated edge traversal
+// Usage: edge_count_bench [num_edges] [num_reps]
+
+#ifndef ENABLE_DYNOGRAPH_EDGE_COUNT
+#define ENABLE_DYNOGRAPH_EDGE_COUNT
+#endif
+#include "edge_count.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Same as STINGER_EDGEBLOCKSIZE
+static const int64_t block_size = 14;
+
+// Per-thread counters packed into a dense array, so neighboring threads share a cache line
+static uint64_t* dense_counters;
+
+// Sums the neighbors of every edge in parallel, one edge block at a time, counting edges with the given method
+static double
+time_traversal(const std::vector<int64_t>& neighbors, int64_t num_reps, int mode, int64_t& checksum)
+{
+    const int64_t num_blocks = (neighbors.size() + block_size - 1) / block_size;
+    const int64_t num_edges = neighbors.size();
+    auto t1 = std::chrono::steady_clock::now();
+    int64_t sum = 0;
+    for (int64_t rep = 0; rep < num_reps; ++rep) {
+        #pragma omp parallel for reduction(+:sum)
+        for (int64_t b = 0; b < num_blocks; ++b) {
+            const int64_t end = std::min(num_edges, (b + 1) * block_size);
+            switch (mode) {
+                case 0: // Not instrumented
+                    for (int64_t i = b * block_size; i < end; ++i) { sum += neighbors[i]; }
+                    break;
+                case 1: // Dense counters, incremented per edge
+                    for (int64_t i = b * block_size; i < end; ++i) {
+                        dense_counters[DYNOGRAPH_EDGE_COUNT_THREAD_ID] += 1;
+                        sum += neighbors[i];
+                    }
+                    break;
+                case 2: // Padded counters, incremented per edge
+                    for (int64_t i = b * block_size; i < end; ++i) {
+                        DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+                        sum += neighbors[i];
+                    }
+                    break;
+                case 3: { // Padded counters, incremented once per edge block
+                    DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();
+                    for (int64_t i = b * block_size; i < end; ++i) {
+                        DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
+                        sum += neighbors[i];
+                    }
+                    DYNOGRAPH_EDGE_COUNT_LOCAL_END();
+                    break;
+                }
+            }
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    checksum = sum;
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+int main(int argc, char *argv[])
+{
+    int64_t num_edges = argc > 1 ? atoll(argv[1]) : 1 << 24;
+    int64_t num_reps = argc > 2 ? atoll(argv[2]) : 10;
+
+    std::vector<int64_t> neighbors(num_edges);
+    for (int64_t i = 0; i < num_edges; ++i) { neighbors[i] = i % 1024; }
+
+    dynograph_edge_count_init();
+    dense_counters = (uint64_t*)calloc(DYNOGRAPH_EDGE_COUNT_THREAD_COUNT, sizeof(uint64_t));
+
+    const char* names[] = {"none", "dense, per edge", "padded, per edge", "padded, per block"};
+    double baseline_ms = 0;
+    printf("%-20s %12s %10s\n", "counters", "time_ms", "overhead");
+    for (int mode = 0; mode < 4; ++mode) {
+        int64_t checksum;
+        // Warm up once before timing
+        time_traversal(neighbors, 1, mode, checksum);
+        double time_ms = time_traversal(neighbors, num_reps, mode, checksum);
+        if (mode == 0) { baseline_ms = time_ms; }
+        printf("%-20s %12.2f %9.1f%%\n", names[mode], time_ms, 100.0 * (time_ms - baseline_ms) / baseline_ms);
+    }
+
+    free(dense_counters);
+    dynograph_edge_count_free();
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "hooks.h"
 #include <chrono>
+#include <map>
 #include <vector>
 #include <valarray>
 #include <iostream>
@@ -7,6 +8,12 @@
 #include "json.hpp"
 #include "../mpi_macros.h"
 #include "edge_count.h"
+#if defined(HOOKS_BINARY_OUTPUT)
+#include <memory>
+#include <limits>
+#include <stdexcept>
+#include "binary_output.h"
+#endif
 // Helper class to manage edge count hooks
 struct edge_count_wrapper
 {
@@ -28,6 +35,17 @@ struct edge_count_wrapper
 #include <omp.h>
 #endif
 
+#if defined(ENABLE_DYNOGRAPH_BUSY_TIME)
+#include <time.h>
+#include <algorithm>
+#include <numeric>
+#endif
+
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+#include <sys/resource.h>
+#include <sstream>
+#endif
+
 #if defined(ENABLE_SNIPER_HOOKS)
 #include <hooks_base.h>
 #elif defined(ENABLE_GEM5_HOOKS)
@@ -53,17 +71,52 @@ static const int json_output_indent_level = 0;
 class Hooks::impl
 {
     friend class Hooks;
+#if defined(HOOKS_BINARY_OUTPUT)
+    // Encodes results and writes them out on a background thread
+    std::unique_ptr<hooks_binary::BinaryWriter> out;
+#else
     // Stream for writing out json results
     std::ofstream out;
-    // Name of the region we are currently in, or "" outside of a region
-    string region_name;
-    // Start and end times of the last region
-    std::chrono::time_point<std::chrono::steady_clock> t1, t2;
+#endif
+    // Measurements for a sub-region, summed over every call within the same parent region
+    struct SubregionTotals
+    {
+        int64_t calls;
+        // Timers and counters, which are added together for each call
+        json measured;
+        // Custom results from set_stat, which keep the last value
+        json stats;
+        std::map<string, SubregionTotals> subregions;
+        SubregionTotals() : calls(0) {}
+    };
+    // State of a region that has begun but not ended yet
+    struct Frame
+    {
+        string name;
+        std::chrono::time_point<std::chrono::steady_clock> t1;
+        // Counter values at the start of the region, used to measure sub-regions
+        vector<uint64_t> edge_count_start;
+        json perf_start;
+        // CPU time consumed by each thread at the start of the region
+        vector<double> busy_start;
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+        // Page fault counts at the start of the region
+        struct rusage usage_start;
+#endif
+        // Dict of custom results that should be printed at the end of this region
+        json stats;
+        // Results of sub-regions that have ended within this region
+        std::map<string, SubregionTotals> subregions;
+    };
+    // Stack of active regions, outermost first
+    vector<Frame> regions;
+    // Number of sub-regions that began outside of any region, these are ignored
+    int64_t num_ignored_subregions;
     // Access edge counter values
     edge_count_wrapper edge_counter;
     // Dict of custom attributes that should be printed after every region_end
     json attrs;
-    // Dict of custom results that should be printed after the next region_end
+    // Dict of custom results set outside of a region, that should be printed after the next region_end
     json stats;
 #if defined(ENABLE_PERF_HOOKS)
     // Names of perf events to collect this run
@@ -83,6 +136,90 @@ class Hooks::impl
     static int get_thread_id() { return 0; }
 #endif
 
+#if defined(ENABLE_DYNOGRAPH_BUSY_TIME)
+    // Threads waiting at a barrier don't consume CPU time (with OMP_WAIT_POLICY=passive),
+    // so the CPU time of each thread over the region measures how long it was doing useful work
+    static double
+    get_thread_cpu_time_ms()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+    }
+
+    static void
+    sample_thread_cpu_times(vector<double> &times)
+    {
+        times.assign(get_num_threads(), 0);
+        #pragma omp parallel
+        {
+            size_t tid = get_thread_id();
+            if (tid < times.size()) { times[tid] = get_thread_cpu_time_ms(); }
+        }
+    }
+
+    // Add the min, max and mean busy time and the load imbalance to the results
+    static void
+    summarize_busy_time(json &results)
+    {
+        if (results.find("thread_busy_ms") == results.end()) { return; }
+        vector<double> busy_ms = results["thread_busy_ms"];
+        double min = *std::min_element(busy_ms.begin(), busy_ms.end());
+        double max = *std::max_element(busy_ms.begin(), busy_ms.end());
+        double mean = std::accumulate(busy_ms.begin(), busy_ms.end(), 0.0) / busy_ms.size();
+        results["thread_busy_ms_min"] = min;
+        results["thread_busy_ms_max"] = max;
+        results["thread_busy_ms_mean"] = mean;
+        // Ratio of the slowest thread to the average, 1.0 means perfectly balanced
+        results["load_imbalance"] = mean > 0 ? max / mean : 1.0;
+    }
+#endif
+
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+    // Reset the peak resident set size, so the high-water mark at the end only covers this region
+    // Requires Linux 4.0 or later, otherwise the peak is over the lifetime of the process
+    static void
+    reset_peak_rss()
+    {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+    }
+
+    // Read a memory size (in kB) from /proc/self/status, or return -1 if it's not available
+    static int64_t
+    read_proc_status_kb(const string &field)
+    {
+        std::ifstream status("/proc/self/status");
+        string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, field.size() + 1, field + ":") == 0) {
+                std::istringstream value(line.substr(field.size() + 1));
+                int64_t kb;
+                if (value >> kb) { return kb; }
+            }
+        }
+        return -1;
+    }
+
+    // Record page faults since the start of the region, and the current and peak memory usage
+    static void
+    record_memory_usage(json &measured, const struct rusage &usage_start, bool top_level)
+    {
+        struct rusage usage_end;
+        getrusage(RUSAGE_SELF, &usage_end);
+        measured["minor_faults"] = static_cast<int64_t>(usage_end.ru_minflt - usage_start.ru_minflt);
+        measured["major_faults"] = static_cast<int64_t>(usage_end.ru_majflt - usage_start.ru_majflt);
+        // Peak memory usage can't be summed over calls, so it's only recorded for top-level regions
+        if (top_level) {
+            int64_t rss_kb = read_proc_status_kb("VmRSS");
+            int64_t hwm_kb = read_proc_status_kb("VmHWM");
+            if (rss_kb >= 0) { measured["rss_kb"] = rss_kb; }
+            // ru_maxrss is also in kB on Linux, but can't be reset
+            measured["rss_hwm_kb"] = hwm_kb >= 0 ? hwm_kb : static_cast<int64_t>(usage_end.ru_maxrss);
+        }
+    }
+#endif
+
     static string
     get_output_filename()
     {
@@ -95,7 +232,106 @@ class Hooks::impl
         }
     }
 
-#if defined(ENABLE_PERF_HOOKS)
+#if defined(HOOKS_BINARY_OUTPUT)
+    // Parses a size in bytes, with an optional K, M or G suffix (powers of 1024)
+    static size_t
+    get_output_buffer_size()
+    {
+        const char* env_buffer_size = getenv("HOOKS_BUFFER_SIZE");
+        if (env_buffer_size == NULL) {
+            // Enough for thousands of regions, so the benchmark only waits if the disk can't keep up
+            return 1 << 20;
+        }
+        const string value(env_buffer_size);
+        long long size = -1;
+        size_t pos = 0;
+        try {
+            size = std::stoll(value, &pos);
+        } catch (const std::logic_error&) {
+            pos = 0;
+        }
+        const string suffix = value.substr(pos);
+        int shift = -1;
+        if (suffix == "") { shift = 0; }
+        else if (suffix == "K" || suffix == "k") { shift = 10; }
+        else if (suffix == "M" || suffix == "m") { shift = 20; }
+        else if (suffix == "G" || suffix == "g") { shift = 30; }
+        if (pos == 0 || shift < 0 || size < 0 || size > (std::numeric_limits<long long>::max() >> shift)) {
+            cerr << "ERROR: Invalid HOOKS_BUFFER_SIZE '" << value << "', expected a number of bytes like 65536, 64K or 1M\n";
+            exit(-1);
+        }
+        size <<= shift;
+        if (static_cast<size_t>(size) < hooks_binary::min_buffer_size) {
+            cerr << "ERROR: HOOKS_BUFFER_SIZE must be at least " << hooks_binary::min_buffer_size << " bytes\n";
+            exit(-1);
+        }
+        return size;
+    }
+#endif
+
+#if defined(ENABLE_NATIVE_PERF_HOOKS)
+
+    // Generic events that perf_event_open supports on most processors, so we don't need libpfm to encode them
+    static vector<string>
+    get_perf_event_names()
+    {
+        return {"", "--perf-event",
+            "PERF_COUNT_HW_CPU_CYCLES",
+            "PERF_COUNT_HW_INSTRUCTIONS",
+            "PERF_COUNT_HW_CACHE_LL_READ_MISS",
+            "PERF_COUNT_HW_CACHE_DTLB_READ_MISS",
+            "PERF_COUNT_HW_BRANCH_MISSES",
+            // Only count events in user space, which doesn't require extra privileges
+            "--perf-exclude-kernel",
+            "--perf-exclude-hv"
+        };
+    }
+
+    static int
+    get_perf_group_size()
+    {
+        if (const char* env_group_size = getenv("PERF_GROUP_SIZE"))
+        {
+            return atoi(env_group_size);
+        } else {
+            // Collect all the built-in events at once
+            return 5;
+        }
+    }
+
+    // Sum of an event counter over all threads, or -1 if it wasn't collected this trial
+    static double
+    get_counter_total(const json &results, const string &event_name)
+    {
+        if (results.find(event_name) == results.end()) { return -1; }
+        double total = 0;
+        for (const json &value : results[event_name]) { total += value.get<double>(); }
+        return total;
+    }
+
+    // Add IPC and misses per thousand instructions to the results
+    static void
+    add_derived_metrics(json &results)
+    {
+        double cycles = get_counter_total(results, "PERF_COUNT_HW_CPU_CYCLES");
+        double instructions = get_counter_total(results, "PERF_COUNT_HW_INSTRUCTIONS");
+        if (cycles > 0 && instructions >= 0) {
+            results["ipc"] = instructions / cycles;
+        }
+        if (instructions > 0) {
+            vector<std::pair<string, string>> miss_events = {
+                {"llc_mpki", "PERF_COUNT_HW_CACHE_LL_READ_MISS"},
+                {"dtlb_mpki", "PERF_COUNT_HW_CACHE_DTLB_READ_MISS"},
+                {"branch_mpki", "PERF_COUNT_HW_BRANCH_MISSES"},
+            };
+            for (auto &metric : miss_events) {
+                double misses = get_counter_total(results, metric.second);
+                if (misses >= 0) { results[metric.first] = 1000 * misses / instructions; }
+            }
+        }
+    }
+
+#elif defined(ENABLE_PERF_HOOKS)
 
     static vector<string>
     get_perf_event_names()
@@ -134,8 +370,12 @@ class Hooks::impl
 #endif
 
     impl()
+#if defined(HOOKS_BINARY_OUTPUT)
+     : out(new hooks_binary::BinaryWriter(get_output_filename(), get_output_buffer_size()))
+#else
      : out(get_output_filename(), std::ofstream::app)
-     , region_name("")
+#endif
+     , num_ignored_subregions(0)
 #if defined(ENABLE_PERF_HOOKS)
      , perf_event_names(get_perf_event_names())
      , perf_group_size(get_perf_group_size())
@@ -145,106 +385,269 @@ class Hooks::impl
     {
     }
 
+#if defined(ENABLE_PERF_HOOKS)
+    // Current value of each perf counter in this trial for each thread, without stopping them
+    json
+    read_perf_counters()
+    {
+        json counters;
+        vector<string> names = perf.event_names(trial, perf_group_size);
+        for (const string &name : names) { counters[name] = vector<uint64_t>(get_num_threads(), 0); }
+        for (int tid = 0; tid < get_num_threads(); ++tid) {
+            vector<unsigned long long> counts = perf.peek(tid, trial, perf_group_size);
+            for (size_t i = 0; i < counts.size() && i < names.size(); ++i) {
+                counters[names[i]][tid] = counts[i];
+            }
+        }
+        return counters;
+    }
+#endif
+
+    // Subtract one set of counters from another, element-wise
+    static json
+    difference(const json &end, const json &start)
+    {
+        json diff = end;
+        for (json::iterator it = diff.begin(); it != diff.end(); ++it) {
+            if (start.find(it.key()) == start.end()) { continue; }
+            const json &before = start[it.key()];
+            for (size_t i = 0; i < it.value().size() && i < before.size(); ++i) {
+                it.value()[i] = it.value()[i].get<uint64_t>() - before[i].get<uint64_t>();
+            }
+        }
+        return diff;
+    }
+
+    // Add a number, or an array of numbers, to a running total
+    static void
+    accumulate(json &total, const json &value)
+    {
+        if (total.is_null()) {
+            total = value;
+        } else if (value.is_array()) {
+            for (size_t i = 0; i < value.size() && i < total.size(); ++i) { accumulate(total[i], value[i]); }
+        } else if (value.is_number_float()) {
+            total = total.get<double>() + value.get<double>();
+        } else if (value.is_number()) {
+            total = total.get<uint64_t>() + value.get<uint64_t>();
+        } else {
+            total = value;
+        }
+    }
+
+    static void
+    merge_subregions(std::map<string, SubregionTotals> &totals, const std::map<string, SubregionTotals> &subregions)
+    {
+        for (const auto &entry : subregions) {
+            SubregionTotals &total = totals[entry.first];
+            total.calls += entry.second.calls;
+            for (json::const_iterator it = entry.second.measured.begin(); it != entry.second.measured.end(); ++it) {
+                accumulate(total.measured[it.key()], it.value());
+            }
+            for (json::const_iterator it = entry.second.stats.begin(); it != entry.second.stats.end(); ++it) {
+                total.stats[it.key()] = it.value();
+            }
+            merge_subregions(total.subregions, entry.second.subregions);
+        }
+    }
+
+    // Add values computed from the raw measurements, which can't be summed across calls
+    static void
+    add_summaries(json &results)
+    {
+#if defined(ENABLE_DYNOGRAPH_BUSY_TIME)
+        summarize_busy_time(results);
+#endif
+#if defined(ENABLE_NATIVE_PERF_HOOKS)
+        add_derived_metrics(results);
+#endif
+    }
+
+    static json
+    subregions_to_json(const std::map<string, SubregionTotals> &subregions)
+    {
+        json results;
+        for (const auto &entry : subregions) {
+            const SubregionTotals &total = entry.second;
+            json subregion = total.measured;
+            add_summaries(subregion);
+            subregion["calls"] = total.calls;
+            for (json::const_iterator it = total.stats.begin(); it != total.stats.end(); ++it) {
+                subregion[it.key()] = it.value();
+            }
+            if (!total.subregions.empty()) {
+                subregion["subregions"] = subregions_to_json(total.subregions);
+            }
+            results[entry.first] = subregion;
+        }
+        return results;
+    }
+
     void __attribute__ ((noinline))
     region_begin(string name)
     {
-        MPI_BARRIER();
-        // Check for mismatched begin/end pairs
-        if (region_name != "") {
-            cerr << "ERROR: called region_begin inside region\n";
-            exit(-1);
-        } else if (name == "") {
+        if (name == "") {
             cerr << "ERROR: region name cannot be empty\n";
             exit(-1);
-        } else {
-            region_name = name;
         }
+        Frame frame;
+        frame.name = name;
+
+        if (regions.empty()) {
+            MPI_BARRIER();
+            // Custom results set before the region began are printed with it
+            frame.stats.swap(stats);
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+            reset_peak_rss();
+#endif
 
-        // Start the ROI
+            // Start the ROI
 #if defined(ENABLE_SNIPER_HOOKS)
-        parmacs_roi_begin();
+            parmacs_roi_begin();
 #elif defined(ENABLE_GEM5_HOOKS)
-        m5_reset_stats(0,0);
+            m5_reset_stats(0,0);
 #elif defined(ENABLE_PIN_HOOKS)
-        __asm__("");
+            __asm__("");
 #elif defined(ENABLE_PERF_HOOKS)
-        // We can only collect perf_group_size events at a time
-        // Collecting more events is done via multiple trials
-        trial = attrs.find("trial") != attrs.end() ? attrs["trial"].get<int>() : 0;
-        // After all event groups have been collected, start over with the first one
-        int trial_max = (perf_event_names.size() + perf_group_size - 1) / perf_group_size;
-        trial = trial % trial_max;
-        #pragma omp parallel
-        {
-            int tid = get_thread_id();
-            perf.open(tid, trial, perf_group_size);
-            perf.start(tid, trial, perf_group_size);
+            // We can only collect perf_group_size events at a time
+            // Collecting more events is done via multiple trials
+            trial = attrs.find("trial") != attrs.end() ? attrs["trial"].get<int>() : 0;
+            // After all event groups have been collected, start over with the first one
+            // Use the parsed event count, since perf_events consumes the event names while parsing them
+            int num_events = perf_events.get_event_cnt();
+            int trial_max = (num_events + perf_group_size - 1) / perf_group_size;
+            trial = trial % trial_max;
+            #pragma omp parallel
+            {
+                int tid = get_thread_id();
+                perf.open(tid, trial, perf_group_size);
+                perf.start(tid, trial, perf_group_size);
+            }
+#endif
+        } else {
+            // Sub-regions share the counters of the outermost region, so save their starting values
+#ifdef ENABLE_DYNOGRAPH_EDGE_COUNT
+            frame.edge_count_start = edge_counter.get_num_traversed_edges();
+#endif
+#if defined(ENABLE_PERF_HOOKS)
+            frame.perf_start = read_perf_counters();
+#endif
         }
+#if defined(ENABLE_DYNOGRAPH_BUSY_TIME)
+        sample_thread_cpu_times(frame.busy_start);
+#endif
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+        getrusage(RUSAGE_SELF, &frame.usage_start);
 #endif
+        regions.push_back(std::move(frame));
+
         // Start the timer
-        t1 = std::chrono::steady_clock::now();
+        regions.back().t1 = std::chrono::steady_clock::now();
     }
 
     void __attribute__ ((noinline))
     region_end()
     {
         // Stop the timer
-        t2 = std::chrono::steady_clock::now();
+        auto t2 = std::chrono::steady_clock::now();
+
+        // Check for mismatched begin/end pairs
+        if (regions.empty()) {
+            cerr << "ERROR: called region_end before region_begin\n";
+            exit(-1);
+        }
+        const bool top_level = regions.size() == 1;
 
         // End the ROI
+        if (top_level) {
 #if defined(ENABLE_SNIPER_HOOKS)
-        parmacs_roi_end();
+            parmacs_roi_end();
 #elif defined(ENABLE_GEM5_HOOKS)
-        m5_dumpreset_stats(0,0);
+            m5_dumpreset_stats(0,0);
 #elif defined(ENABLE_PIN_HOOKS)
-        __asm__("");
+            __asm__("");
 #elif defined(ENABLE_PERF_HOOKS)
-        #pragma omp parallel
-        {
-            int tid = get_thread_id();
-            perf.stop(tid, trial, perf_group_size);
-        }
+            #pragma omp parallel
+            {
+                int tid = get_thread_id();
+                perf.stop(tid, trial, perf_group_size);
+            }
 #endif
-
-        // Check for mismatched begin/end pairs
-        if (region_name == "") {
-            cerr << "ERROR: called region_end before region_begin\n";
-            exit(-1);
         }
 
-        // Populate the results object
-        json results;
+        Frame &frame = regions.back();
 
+        // Collect timers and counters for this region
+        json measured;
         // Save # of traversed edges if the function was used
 #ifdef ENABLE_DYNOGRAPH_EDGE_COUNT
-        results["num_traversed_edges"] = edge_counter.get_num_traversed_edges();
-        edge_counter.reset();
+        if (top_level) {
+            measured["num_traversed_edges"] = edge_counter.get_num_traversed_edges();
+            edge_counter.reset();
+        } else {
+            json start = {{"num_traversed_edges", frame.edge_count_start}};
+            json end = {{"num_traversed_edges", edge_counter.get_num_traversed_edges()}};
+            measured["num_traversed_edges"] = difference(end, start)["num_traversed_edges"];
+        }
 #endif
         // Record time elapsed
-        results["time_ms"] = std::chrono::duration<double, std::milli>(t2-t1).count();
+        measured["time_ms"] = std::chrono::duration<double, std::milli>(t2-frame.t1).count();
+#if defined(ENABLE_DYNOGRAPH_BUSY_TIME)
+        // Record per-thread busy time
+        vector<double> busy_end;
+        sample_thread_cpu_times(busy_end);
+        vector<double> busy_ms(busy_end.size());
+        for (size_t i = 0; i < busy_ms.size(); ++i) { busy_ms[i] = busy_end[i] - frame.busy_start[i]; }
+        measured["thread_busy_ms"] = busy_ms;
+#endif
+#if defined(ENABLE_DYNOGRAPH_MEMORY_STATS)
+        record_memory_usage(measured, frame.usage_start, top_level);
+#endif
+#if defined(ENABLE_PERF_HOOKS)
+        if (top_level) {
+            // Copy recorded counters into the output
+            json counters = json::parse(perf.toString(trial, perf_group_size));
+            for (json::iterator it = counters.begin(); it != counters.end(); ++it) {
+                measured[it.key()] = it.value();
+            }
+        } else {
+            json counters = difference(read_perf_counters(), frame.perf_start);
+            for (json::iterator it = counters.begin(); it != counters.end(); ++it) {
+                measured[it.key()] = it.value();
+            }
+        }
+#endif
 
-        // Copy stats to the results object
-        for (json::iterator it = stats.begin(); it != stats.end(); ++it){
-            results[it.key()] = it.value();
+        if (!top_level) {
+            // Add the results to the parent region, they will be printed when it ends
+            std::map<string, SubregionTotals> totals;
+            SubregionTotals &total = totals[frame.name];
+            total.calls = 1;
+            total.measured = measured;
+            total.stats = frame.stats;
+            total.subregions.swap(frame.subregions);
+            regions.pop_back();
+            merge_subregions(regions.back().subregions, totals);
+            return;
         }
-        // Stats get cleared at the end of each region, attrs do not.
-        stats.clear();
 
-#if defined(ENABLE_PERF_HOOKS)
-        // Copy recorded counters into the output
-        json counters = json::parse(perf.toString(trial, perf_group_size));
-        for (json::iterator it = counters.begin(); it != counters.end(); ++it) {
+        // Populate the results object
+        json results = measured;
+        add_summaries(results);
+
+        // Copy stats to the results object
+        for (json::iterator it = frame.stats.begin(); it != frame.stats.end(); ++it){
             results[it.key()] = it.value();
         }
-#endif
+        if (!frame.subregions.empty()) {
+            results["subregions"] = subregions_to_json(frame.subregions);
+        }
 
         combine_results(results);
         MPI_RANK_0_ONLY {
 
         // Set region name in output
-        results["region_name"] = region_name;
-        // Reset for next region
-        region_name = "";
+        results["region_name"] = frame.name;
 
         // Append custom attributes
         for (json::iterator it = attrs.begin(); it != attrs.end(); ++it){
@@ -254,13 +657,38 @@ class Hooks::impl
 
         // At this point we've accumulated all the data for this ROI into a json object (results)
         // Finally, send it to the output stream
+#if defined(HOOKS_BINARY_OUTPUT)
+        out->write(results);
+#else
         out << std::setw(json_output_indent_level) << results << std::endl;
+#endif
 
         } // end MPI_RANK_0_ONLY
         MPI_BARRIER();
 
         // Reset for next region
-        region_name = "";
+        regions.pop_back();
+    }
+
+    // Sub-regions from library code are only recorded when they are inside a region
+    void
+    subregion_begin(string name)
+    {
+        if (regions.empty()) {
+            ++num_ignored_subregions;
+        } else {
+            region_begin(name);
+        }
+    }
+
+    void
+    subregion_end()
+    {
+        if (regions.empty() && num_ignored_subregions > 0) {
+            --num_ignored_subregions;
+        } else {
+            region_end();
+        }
     }
 
     void
@@ -321,7 +749,12 @@ class Hooks::impl
     template<typename T>
     void
     set_stat(std::string key, T value) {
-        stats[key] = value;
+        // Stats set inside a region belong to the innermost region
+        if (regions.empty()) {
+            stats[key] = value;
+        } else {
+            regions.back().stats[key] = value;
+        }
     }
 
 };
@@ -341,6 +774,8 @@ Hooks::Hooks()                                              { pimpl = new Hooks:
 Hooks::~Hooks()                                             { delete pimpl; }
 void Hooks::region_begin(string name)                       { pimpl->region_begin(name); }
 void Hooks::region_end()                                    { pimpl->region_end(); }
+void Hooks::subregion_begin(string name)                    { pimpl->subregion_begin(name); }
+void Hooks::subregion_end()                                 { pimpl->subregion_end(); }
 void Hooks::set_attr(std::string key, uint64_t value)       { pimpl->set_attr(key, value); }
 void Hooks::set_attr(std::string key, int64_t value)        { pimpl->set_attr(key, value); }
 void Hooks::set_attr(std::string key, double value)         { pimpl->set_attr(key, value); }
@@ -365,6 +800,18 @@ hooks_region_end()
     Hooks::getInstance().region_end();
 }
 
+extern "C" void
+hooks_subregion_begin(const char* name)
+{
+    Hooks::getInstance().subregion_begin(name);
+}
+
+extern "C" void
+hooks_subregion_end()
+{
+    Hooks::getInstance().subregion_end();
+}
+
 extern "C" void
 hooks_set_attr_i64(const char * key, int64_t value)
 {
@@ -11,7 +11,12 @@ public:
     // Marks the start of a new phase of computation
     void region_begin(std::string name);
     // Marks the end of the current phase of computation
+    // Regions can be nested, results for each sub-region are summed up and printed with the outermost region
     void region_end();
+    // Same as region_begin/region_end, but does nothing outside of a region
+    // Use these to mark phases of computation within library code
+    void subregion_begin(std::string name);
+    void subregion_end();
     // Set a custom data value that will be included in the JSON output at the end of every region
     void set_attr(std::string key, uint64_t value);
     void set_attr(std::string key, int64_t value);
@@ -0,0 +1,24 @@
+// Converts a binary hooks file to the same JSON lines that the hooks write by default
+// Usage: hooks_bin_to_json [input.bin] > output.json, reads from stdin if no input is given
+
+#include <cstdio>
+#include <iostream>
+#include "binary_output.h"
+
+int main(int argc, const char* argv[])
+{
+    FILE* fp = argc > 1 ? fopen(argv[1], "rb") : stdin;
+    if (fp == NULL) {
+        std::cerr << "ERROR: Unable to open " << argv[1] << "\n";
+        return -1;
+    }
+    bool ok = hooks_binary::read_binary_output(fp, [](nlohmann::json& results) {
+        std::cout << results << "\n";
+    });
+    if (fp != stdin) { fclose(fp); }
+    if (!ok) {
+        std::cerr << "ERROR: Invalid binary hooks file, output may be incomplete\n";
+        return -1;
+    }
+    return 0;
+}
@@ -9,6 +9,8 @@ extern "C" {
 
 void hooks_region_begin(const char* name);
 void hooks_region_end();
+void hooks_subregion_begin(const char* name);
+void hooks_subregion_end();
 void hooks_set_attr_u64(const char * key, uint64_t value);
 void hooks_set_attr_i64(const char * key, int64_t value);
 void hooks_set_attr_f64(const char * key, double value);
@@ -18,4 +20,14 @@ void hooks_set_attr_str(const char * key, const char* value);
 }
 #endif
 
+// Marks phases of computation within a region, such as the passes of an insert or an algorithm
+// These compile to nothing unless ENABLE_DYNOGRAPH_SUBREGIONS is defined
+#if defined(ENABLE_DYNOGRAPH_SUBREGIONS)
+#define DYNOGRAPH_SUBREGION_BEGIN(NAME) hooks_subregion_begin(NAME)
+#define DYNOGRAPH_SUBREGION_END() hooks_subregion_end()
+#else
+#define DYNOGRAPH_SUBREGION_BEGIN(NAME) do {} while (0)
+#define DYNOGRAPH_SUBREGION_END() do {} while (0)
+#endif
+
 #endif //HOOKS_C_H
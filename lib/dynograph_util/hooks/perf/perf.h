@@ -159,6 +159,20 @@ public:
         return _perf_cnt;
     }
 
+    // Read the current value without stopping the counter
+    unsigned long long peek(void)
+    {
+        if (_perf == -1) return 0;
+
+        struct read_format ret;
+        long int n = read(_perf, &ret, sizeof(struct read_format));
+        if (n < 0 || ret.time_running == 0) return 0;
+
+        if (ret.time_enabled != ret.time_running)
+            return ret.value * ((double)ret.time_enabled / (double)ret.time_running);
+        return ret.value;
+    }
+
     unsigned long long get_perf_cnt(void) { return _perf_cnt; }
     bool is_multiplexing(void) { return _multiplexing; }
 
@@ -382,6 +396,21 @@ public:
         }
     }
 
+    std::vector<unsigned long long> peek(int group_id=-1, unsigned group_size=DEFAULT_PERF_GRP_SZ)
+    {
+        size_t start = (group_id == -1)? 0 : group_id*group_size;
+        size_t end = (group_id == -1)? _perf_vec.size() : start+group_size;
+        std::vector<unsigned long long> counts;
+        if (start >= _perf_vec.size()) return counts;
+        if (end > _perf_vec.size()) end = _perf_vec.size();
+
+        for (size_t i=start;i<end;i++)
+        {
+            counts.push_back(_perf_vec[i].peek());
+        }
+        return counts;
+    }
+
     std::string toString(int group_id=-1, unsigned group_size=DEFAULT_PERF_GRP_SZ)
     {
         size_t start = (group_id == -1)? 0 : group_id*group_size;
@@ -702,6 +731,21 @@ public:
         if (tid >= _perf_vec.size()) return;
         _perf_vec[tid].stop(group_id, group_size);
     }
+    // Current counts for each event in the group, without stopping the counters
+    std::vector<unsigned long long> peek(unsigned tid, int group_id=-1, unsigned group_size=DEFAULT_PERF_GRP_SZ)
+    {
+        if (tid >= _perf_vec.size()) return std::vector<unsigned long long>();
+        return _perf_vec[tid].peek(group_id, group_size);
+    }
+    std::vector<std::string> event_names(int group_id=-1, unsigned group_size=DEFAULT_PERF_GRP_SZ)
+    {
+        size_t start = (group_id == -1)? 0 : group_id*group_size;
+        size_t end = (group_id == -1)? _perf_vec[0].get_event_cnt() : start+group_size;
+        if (end > _perf_vec[0].get_event_cnt()) end = _perf_vec[0].get_event_cnt();
+        std::vector<std::string> names;
+        for (size_t c=start;c<end;c++) { names.push_back(_perf_vec[0].event_name(c)); }
+        return names;
+    }
     std::string toString(int group_id=-1, unsigned group_size=DEFAULT_PERF_GRP_SZ)
     {
         size_t start = (group_id == -1)? 0 : group_id*group_size;
@@ -0,0 +1,120 @@
+#include "update_latency.h"
+#include "hooks.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+uint64_t
+LatencyHistogram::bucket_value(int64_t index)
+{
+    if (index < sub_bucket_count) { return index; }
+    int64_t shift = index / sub_bucket_count - 1;
+    int64_t sub_bucket = index % sub_bucket_count;
+    uint64_t lower = static_cast<uint64_t>(sub_bucket_count + sub_bucket) << shift;
+    return lower + ((1ULL << shift) >> 1);
+}
+
+void
+LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (int64_t i = 0; i < num_buckets; ++i) { counts[i] += other.counts[i]; }
+    total_count += other.total_count;
+    max_value = std::max(max_value, other.max_value);
+}
+
+void
+LatencyHistogram::reset()
+{
+    std::fill(counts.begin(), counts.end(), 0);
+    total_count = 0;
+    max_value = 0;
+}
+
+uint64_t
+LatencyHistogram::get_percentile(double fraction) const
+{
+    if (total_count == 0) { return 0; }
+    uint64_t target = std::max<uint64_t>(1, std::ceil(fraction * total_count));
+    uint64_t cumulative = 0;
+    for (int64_t i = 0; i < num_buckets; ++i) {
+        cumulative += counts[i];
+        // The bucket midpoint may overshoot the largest value we actually saw
+        if (cumulative >= target) { return std::min(bucket_value(i), max_value); }
+    }
+    return max_value;
+}
+
+// Returns zero if sampling is turned off
+static int64_t
+get_sample_period()
+{
+    double rate = 0.01;
+    if (const char* env_rate = getenv("HOOKS_LATENCY_SAMPLE_RATE")) {
+        char* end;
+        rate = strtod(env_rate, &end);
+        if (end == env_rate || *end != '\0' || !(rate >= 0 && rate <= 1)) {
+            std::cerr << "ERROR: Invalid HOOKS_LATENCY_SAMPLE_RATE '" << env_rate
+                      << "', expected a fraction between 0 and 1\n";
+            exit(-1);
+        }
+    }
+    if (rate == 0) { return 0; }
+    return std::max<int64_t>(1, std::llround(1.0 / rate));
+}
+
+// Sets the sample count and percentiles of one histogram as hooks stats, with names starting with prefix
+static void
+report_histogram(const std::string& prefix, const LatencyHistogram& histogram)
+{
+    Hooks &hooks = Hooks::getInstance();
+    hooks.set_stat(prefix + "_samples", histogram.get_total_count());
+    if (histogram.get_total_count() == 0) { return; }
+    hooks.set_stat(prefix + "_ns_p50", histogram.get_percentile(0.50));
+    hooks.set_stat(prefix + "_ns_p90", histogram.get_percentile(0.90));
+    hooks.set_stat(prefix + "_ns_p99", histogram.get_percentile(0.99));
+    hooks.set_stat(prefix + "_ns_p99_9", histogram.get_percentile(0.999));
+    hooks.set_stat(prefix + "_ns_max", histogram.get_max());
+}
+
+UpdateLatencySampler::UpdateLatencySampler()
+#if defined(_OPENMP)
+: threads(omp_get_max_threads())
+#else
+: threads(1)
+#endif
+, sample_period(get_sample_period())
+{
+    reset();
+}
+
+UpdateLatencySampler&
+UpdateLatencySampler::get_instance()
+{
+    static UpdateLatencySampler instance;
+    return instance;
+}
+
+void
+UpdateLatencySampler::reset()
+{
+    for (ThreadState& thread : threads) {
+        // Stagger the first sample on each thread, so we don't always time the first update in each chunk
+        thread.countdown = sample_period > 0 ? 1 + (&thread - &threads[0]) % sample_period : 0;
+        thread.updates.reset();
+        thread.ranges.reset();
+    }
+}
+
+void
+UpdateLatencySampler::report()
+{
+    LatencyHistogram updates, ranges;
+    for (const ThreadState& thread : threads) {
+        updates.merge(thread.updates);
+        ranges.merge(thread.ranges);
+    }
+    report_histogram("update_latency", updates);
+    report_histogram("update_range_latency", ranges);
+}
@@ -0,0 +1,156 @@
+/**
+ * update_latency.h
+ *
+ * Defines macros for sampling the latency of individual graph updates.
+ * Wrap each update (or each group of updates that complete together) in
+ * DYNOGRAPH_UPDATE_LATENCY_BEGIN(num_updates) and DYNOGRAPH_UPDATE_LATENCY_END().
+ * A fraction of updates (HOOKS_LATENCY_SAMPLE_RATE, default 0.01, 0 turns sampling off) are timed and
+ * added to a per-thread histogram. Groups of updates are timed as a whole and kept in a separate
+ * range histogram. Call dynograph_update_latency_reset() before each batch
+ * and dynograph_update_latency_report() at the end to add percentiles to the hooks output.
+ *
+ * These compile to nothing unless ENABLE_DYNOGRAPH_UPDATE_LATENCY is defined.
+ */
+
+#ifndef DYNOGRAPH_UPDATE_LATENCY_H
+#define DYNOGRAPH_UPDATE_LATENCY_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#define DYNOGRAPH_UPDATE_LATENCY_THREAD_ID omp_get_thread_num()
+#else
+#define DYNOGRAPH_UPDATE_LATENCY_THREAD_ID 0
+#endif
+
+// Histogram with logarithmically sized buckets, like HdrHistogram
+// Each power of two is split into 16 linear buckets, so values are recorded to within 1/16th (6%)
+class LatencyHistogram
+{
+private:
+    static const int sub_bucket_bits = 4;
+    static const int64_t sub_bucket_count = 1 << sub_bucket_bits;
+    static const int64_t num_buckets = sub_bucket_count * (64 - sub_bucket_bits + 1);
+    std::vector<uint64_t> counts;
+    uint64_t total_count;
+    uint64_t max_value;
+
+    static int64_t
+    bucket_index(uint64_t value)
+    {
+        // Small values get a bucket each
+        if (value < static_cast<uint64_t>(sub_bucket_count)) { return value; }
+        // Otherwise, use the position of the highest set bit and the next few bits below it
+        int64_t shift = (63 - __builtin_clzll(value)) - sub_bucket_bits;
+        int64_t sub_bucket = (value >> shift) & (sub_bucket_count - 1);
+        return sub_bucket_count * (shift + 1) + sub_bucket;
+    }
+    // Middle of the range of values that fall into a bucket
+    static uint64_t bucket_value(int64_t index);
+
+public:
+    LatencyHistogram() : counts(num_buckets, 0), total_count(0), max_value(0) {}
+    void
+    add(uint64_t value, uint64_t count = 1)
+    {
+        counts[bucket_index(value)] += count;
+        total_count += count;
+        if (value > max_value) { max_value = value; }
+    }
+    void merge(const LatencyHistogram& other);
+    void reset();
+    uint64_t get_total_count() const { return total_count; }
+    uint64_t get_max() const { return max_value; }
+    // Smallest value that is greater than or equal to the given fraction of recorded values
+    uint64_t get_percentile(double fraction) const;
+};
+
+// Decides which updates to time and records the results for each thread
+class UpdateLatencySampler
+{
+private:
+    struct ThreadState
+    {
+        // Number of updates until the next one is timed
+        int64_t countdown;
+        // Latency of single updates
+        LatencyHistogram updates;
+        // Latency of groups of updates that complete together
+        LatencyHistogram ranges;
+        // countdown is written on every update, so keep each thread's state a cache line away from the next
+        // (not alignas, since std::allocator doesn't honor over-alignment before C++17)
+        char padding[64];
+    };
+    std::vector<ThreadState> threads;
+    // Time one out of every sample_period updates, or none if zero
+    int64_t sample_period;
+    UpdateLatencySampler();
+public:
+    static UpdateLatencySampler& get_instance();
+
+    // Returns the number of sampled updates within a group of num_updates updates on this thread
+    // A group with any sampled updates should be timed
+    int64_t
+    sample(int thread_id, int64_t num_updates)
+    {
+        if (sample_period == 0) { return 0; }
+        int64_t &countdown = threads[thread_id].countdown;
+        countdown -= num_updates;
+        if (countdown > 0) { return 0; }
+        // A group larger than the period may pass over several sample points
+        int64_t num_samples = -countdown / sample_period + 1;
+        countdown += num_samples * sample_period;
+        return num_samples;
+    }
+
+    // Every update in the group completed after the same latency, count it once for each sample point it passed
+    void
+    record(int thread_id, int64_t num_updates, int64_t num_samples, std::chrono::steady_clock::duration latency)
+    {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        ThreadState &thread = threads[thread_id];
+        if (num_updates == 1) {
+            thread.updates.add(ns, num_samples);
+        } else {
+            thread.ranges.add(ns, num_samples);
+        }
+    }
+
+    void reset();
+    // Merge histograms from every thread, and set percentiles as hooks stats
+    void report();
+};
+
+#if defined(ENABLE_DYNOGRAPH_UPDATE_LATENCY)
+
+#define DYNOGRAPH_UPDATE_LATENCY_BEGIN(NUM_UPDATES)                                                           \
+    const int64_t dynograph_latency_num_updates__ = (NUM_UPDATES);                                           \
+    const int64_t dynograph_latency_num_samples__ = UpdateLatencySampler::get_instance().sample(            \
+        DYNOGRAPH_UPDATE_LATENCY_THREAD_ID, dynograph_latency_num_updates__);                                \
+    const std::chrono::steady_clock::time_point dynograph_latency_t1__ =                                     \
+        dynograph_latency_num_samples__ > 0 ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+#define DYNOGRAPH_UPDATE_LATENCY_END()                                                                        \
+    if (dynograph_latency_num_samples__ > 0) {                                                               \
+        UpdateLatencySampler::get_instance().record(DYNOGRAPH_UPDATE_LATENCY_THREAD_ID,                      \
+            dynograph_latency_num_updates__, dynograph_latency_num_samples__,                                \
+            std::chrono::steady_clock::now() - dynograph_latency_t1__);                                      \
+    }
+
+#define dynograph_update_latency_reset() UpdateLatencySampler::get_instance().reset()
+#define dynograph_update_latency_report() UpdateLatencySampler::get_instance().report()
+
+#else
+
+// Do nothing when disabled for zero overhead
+#define DYNOGRAPH_UPDATE_LATENCY_BEGIN(NUM_UPDATES)
+#define DYNOGRAPH_UPDATE_LATENCY_END()
+#define dynograph_update_latency_reset()
+#define dynograph_update_latency_report()
+
+#endif
+
+#endif // DYNOGRAPH_UPDATE_LATENCY_H
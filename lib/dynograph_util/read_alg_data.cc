@@ -0,0 +1,27 @@
+#include "alg_data_writer.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string>
+
+using namespace DynoGraph;
+
+// Reconstructs the results of an algorithm at a given epoch from a DYNOGRAPH_ALG_DATA_PATH dump,
+// and writes them to stdout as a binary array of int64_t
+int main(int argc, const char* argv[])
+{
+    Logger& logger = Logger::get_instance();
+    if (argc != 4) {
+        logger << "Usage: " << argv[0] << " <alg_data_path> <alg_name> <epoch> > output.bin\n";
+        die();
+    }
+    std::string path = argv[1];
+    std::string alg_name = argv[2];
+    int64_t epoch = static_cast<int64_t>(std::stoll(argv[3]));
+
+    pvector<int64_t> data = read_alg_data(path, alg_name, epoch);
+    if (fwrite(data.data(), sizeof(int64_t), data.size(), stdout) != data.size()) {
+        logger << "Failed to write alg data\n";
+        die();
+    }
+    return 0;
+}
@@ -0,0 +1,312 @@
+#include "streaming_dataset.h"
+#include "helpers.h"
+#include "logger.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <limits>
+
+using namespace DynoGraph;
+using std::shared_ptr;
+using std::make_shared;
+
+// Read n edges starting at edge index first_edge from a binary edge list
+static void
+read_edges(int fd, int64_t first_edge, int64_t n, Edge* dst)
+{
+    char* buf = reinterpret_cast<char*>(dst);
+    size_t bytes_left = n * sizeof(Edge);
+    off_t offset = first_edge * sizeof(Edge);
+    // pread may return fewer bytes than requested, so keep reading until we have all of them
+    while (bytes_left > 0)
+    {
+        ssize_t rc = pread(fd, buf, bytes_left, offset);
+        if (rc <= 0) {
+            Logger::get_instance() << "Failed to read edges " << first_edge
+                << " through " << first_edge + n << " from disk\n";
+            die();
+        }
+        buf += rc;
+        offset += rc;
+        bytes_left -= rc;
+    }
+}
+
+StreamingBatch::StreamingBatch(int fd, int64_t first_edge, int64_t num_edges)
+: ConcreteBatch(num_edges)
+{
+    if (num_edges > 0) { read_edges(fd, first_edge, num_edges, &edges[0]); }
+
+    // Initialize batch pointers
+    begin_iter = &*edges.begin();
+    end_iter = &*edges.end();
+}
+
+StreamingDataset::StreamingDataset(Args args)
+: args(args)
+, directed(true)
+, fd(-1)
+, prefetch_begin(0)
+, prefetch_end(0)
+, loading_batch(-1)
+, done(false)
+{
+    Logger &logger = Logger::get_instance();
+    if (!has_suffix(args.input_path, ".graph.bin")) {
+        logger << "Streaming is only supported for .graph.bin files, can't stream " << args.input_path << "\n";
+        die();
+    }
+
+    fd = open(args.input_path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        logger << "Failed to open " << args.input_path << "\n";
+        die();
+    }
+    num_edges = st.st_size / sizeof(Edge);
+
+    // Intentionally rounding down to make it divide evenly
+    int64_t num_batches = num_edges / args.batch_size;
+
+    // Sanity check on arguments
+    if (args.batch_size > num_edges)
+    {
+        logger << "Invalid arguments: batch size (" << args.batch_size << ") "
+               << "cannot be larger than the total number of edges in the dataset "
+               << " (" << num_edges << ")\n";
+        die();
+    }
+
+    if (args.num_epochs > num_batches)
+    {
+        logger << "Invalid arguments: number of epochs (" << args.num_epochs << ") "
+               << "cannot be greater than the number of batches in the dataset "
+               << "(" << num_batches << ")\n";
+        die();
+    }
+
+    index.resize(num_batches);
+    buildIndex();
+
+    // Start loading the first few batches in the background
+    prefetch_end = std::min(args.stream_window, num_batches);
+    prefetch_thread = std::thread(&StreamingDataset::prefetch, this);
+}
+
+StreamingDataset::~StreamingDataset()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_all();
+    prefetch_thread.join();
+    close(fd);
+}
+
+// Makes a single pass over the file to validate the edges and record the timestamp range of each batch
+void
+StreamingDataset::buildIndex()
+{
+    Logger &logger = Logger::get_instance();
+    std::string directedStr = directed ? "directed" : "undirected";
+    logger << "Indexing " << num_edges << " "
+           << directedStr
+           << " edges from " << args.input_path << "...\n";
+
+    const int64_t block_size = 1024 * 1024;
+    const int64_t batch_size = args.batch_size;
+    const int64_t num_batches = index.size();
+    pvector<Edge> block(block_size);
+
+    int64_t max_id = 0;
+    bool sorted = true;
+    bool self_edges = false;
+    int64_t prev_timestamp = std::numeric_limits<int64_t>::min();
+    for (int64_t first = 0; first < num_edges; first += block_size)
+    {
+        int64_t n = std::min(block_size, num_edges - first);
+        read_edges(fd, first, n, &block[0]);
+
+        #pragma omp parallel for reduction(max : max_id) reduction(&& : sorted) reduction(|| : self_edges)
+        for (int64_t i = 0; i < n; ++i)
+        {
+            const Edge& e = block[i];
+            max_id = std::max(max_id, std::max(e.src, e.dst));
+            int64_t prev = (i == 0) ? prev_timestamp : block[i-1].timestamp;
+            sorted = sorted && prev <= e.timestamp;
+            self_edges = self_edges || e.src == e.dst;
+
+            // Record the first and last timestamp of each batch
+            int64_t k = first + i;
+            int64_t batch_id = k / batch_size;
+            if (batch_id < num_batches) {
+                if (k % batch_size == 0) { index[batch_id].first_timestamp = e.timestamp; }
+                if (k % batch_size == batch_size - 1) { index[batch_id].last_timestamp = e.timestamp; }
+            }
+        }
+
+        if (first == 0) { min_timestamp = block[0].timestamp; }
+        prev_timestamp = block[n-1].timestamp;
+    }
+    max_timestamp = prev_timestamp;
+    max_vertex_id = max_id;
+
+    // Make sure edges are sorted by timestamp
+    if (!sorted)
+    {
+        logger << "Invalid dataset: edges not sorted by timestamp\n";
+        die();
+    }
+
+    // Make sure there are no self-edges
+    if (self_edges) {
+        logger << "Invalid dataset: no self-edges allowed\n";
+        die();
+    }
+}
+
+// Runs in the background, loading batches in the prefetch range that are not yet in memory
+void
+StreamingDataset::prefetch()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        // Find the first batch in the prefetch range that hasn't been loaded yet
+        int64_t batch_id = -1;
+        cv.wait(lock, [&]() {
+            for (int64_t i = prefetch_begin; i < prefetch_end; ++i) {
+                if (resident_batches.find(i) == resident_batches.end()) {
+                    batch_id = i;
+                    return true;
+                }
+            }
+            return done;
+        });
+        if (done) { break; }
+
+        // Read the batch without holding the lock
+        loading_batch = batch_id;
+        lock.unlock();
+        shared_ptr<Batch> batch = make_shared<StreamingBatch>(fd, batch_id * args.batch_size, args.batch_size);
+        lock.lock();
+        loading_batch = -1;
+
+        // Keep the batch only if the window hasn't moved past it in the meantime
+        // (prefetch_begin - 1 is the batch currently being requested by getBatch)
+        if (batch_id >= prefetch_begin - 1 && batch_id < prefetch_end) {
+            resident_batches[batch_id] = batch;
+        }
+        cv.notify_all();
+    }
+}
+
+int64_t
+StreamingDataset::getTimestampForWindow(int64_t batchId) const
+{
+    int64_t timestamp;
+
+    // Calculate width of timestamp window
+    int64_t window_time = round_down(args.window_size * (max_timestamp - min_timestamp));
+    // Get the timestamp of the last edge in the current batch
+    int64_t latest_time = index[batchId].last_timestamp;
+
+    timestamp = std::max(min_timestamp, latest_time - window_time);
+
+    return timestamp;
+}
+
+shared_ptr<Batch>
+StreamingDataset::getBatch(int64_t batchId)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Drop batches that fall outside the new window
+    for (auto it = resident_batches.begin(); it != resident_batches.end(); ) {
+        if (it->first < batchId || it->first >= batchId + args.stream_window) {
+            it = resident_batches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Move the window forward and wake up the prefetch thread
+    prefetch_begin = batchId + 1;
+    prefetch_end = std::min(batchId + args.stream_window, getNumBatches());
+    cv.notify_all();
+
+    // If the prefetch thread is currently reading this batch, wait for it to finish
+    cv.wait(lock, [&]() { return loading_batch != batchId; });
+
+    auto it = resident_batches.find(batchId);
+    if (it != resident_batches.end()) {
+        shared_ptr<Batch> batch = it->second;
+        resident_batches.erase(it);
+        return batch;
+    }
+
+    // Batch wasn't prefetched, read it now
+    lock.unlock();
+    return make_shared<StreamingBatch>(fd, batchId * args.batch_size, args.batch_size);
+}
+
+shared_ptr<Batch>
+StreamingDataset::getBatchesUpTo(int64_t batchId)
+{
+    // Skip over batches that fall entirely outside the window, they would be filtered out anyway
+    int64_t threshold = getTimestampForWindow(batchId);
+    auto first = std::lower_bound(index.begin(), index.begin() + batchId, threshold,
+        [](const BatchIndex& b, int64_t t) { return b.last_timestamp < t; });
+    int64_t first_batch = first - index.begin();
+
+    int64_t first_edge = first_batch * args.batch_size;
+    int64_t last_edge = (batchId + 1) * args.batch_size;
+    return make_shared<StreamingBatch>(fd, first_edge, last_edge - first_edge);
+}
+
+bool
+StreamingDataset::isDirected() const
+{
+    return directed;
+}
+
+int64_t
+StreamingDataset::getMaxVertexId() const
+{
+    return max_vertex_id;
+}
+
+int64_t
+StreamingDataset::getNumBatches() const {
+    return static_cast<int64_t>(index.size());
+}
+
+int64_t
+StreamingDataset::getNumEdges() const {
+    return num_edges;
+}
+
+int64_t
+StreamingDataset::getMinTimestamp() const {
+    return min_timestamp;
+}
+
+int64_t
+StreamingDataset::getMaxTimestamp() const {
+    return max_timestamp;
+}
+
+void
+StreamingDataset::reset()
+{
+    // Start prefetching from the beginning again
+    std::lock_guard<std::mutex> lock(mutex);
+    resident_batches.clear();
+    prefetch_begin = 0;
+    prefetch_end = std::min(args.stream_window, getNumBatches());
+    cv.notify_all();
+}
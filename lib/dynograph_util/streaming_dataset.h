@@ -0,0 +1,77 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "args.h"
+#include "batch.h"
+#include "idataset.h"
+#include "pvector.h"
+
+namespace DynoGraph {
+
+// Batch that reads its edges from a binary edge list on disk
+class StreamingBatch : public ConcreteBatch
+{
+public:
+    explicit StreamingBatch(int fd, int64_t first_edge, int64_t num_edges);
+};
+
+// Dataset that reads batches from a .graph.bin file on demand, instead of preloading the whole edge list
+// A background thread prefetches upcoming batches, at most args.stream_window batches are kept in memory
+class StreamingDataset : public IDataset
+{
+private:
+    // Timestamp range of each batch, computed in a single pass over the file at startup
+    struct BatchIndex
+    {
+        int64_t first_timestamp;
+        int64_t last_timestamp;
+    };
+
+    void buildIndex();
+    void prefetch();
+
+    Args args;
+    bool directed;
+    int fd;
+    int64_t num_edges;
+    int64_t max_vertex_id;
+    int64_t min_timestamp;
+    int64_t max_timestamp;
+
+    pvector<BatchIndex> index;
+
+    // Batches that have been read from disk, indexed by batch ID
+    std::map<int64_t, std::shared_ptr<Batch>> resident_batches;
+    // Range of batches the prefetch thread should try to load
+    int64_t prefetch_begin;
+    int64_t prefetch_end;
+    // Batch the prefetch thread is currently reading, or -1
+    int64_t loading_batch;
+    bool done;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread prefetch_thread;
+
+public:
+    StreamingDataset(Args args);
+    ~StreamingDataset();
+
+    int64_t getTimestampForWindow(int64_t batchId) const;
+    std::shared_ptr<Batch> getBatch(int64_t batchId);
+    std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId);
+    int64_t getNumBatches() const;
+    int64_t getNumEdges() const;
+    int64_t getMinTimestamp() const;
+    int64_t getMaxTimestamp() const;
+
+    bool isDirected() const;
+    int64_t getMaxVertexId() const;
+
+    void reset();
+};
+
+} // end namespace DynoGraph
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+namespace DynoGraph {
+
+// Map signed integers to unsigned so that small negative numbers stay small
+inline uint64_t
+zigzag_encode(int64_t x)
+{
+    return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+}
+
+inline int64_t
+zigzag_decode(uint64_t x)
+{
+    return static_cast<int64_t>(x >> 1) ^ -static_cast<int64_t>(x & 1);
+}
+
+// Append a zigzag-encoded LEB128 varint to out
+inline void
+put_varint(std::vector<uint8_t>& out, int64_t value)
+{
+    uint64_t x = zigzag_encode(value);
+    while (x >= 0x80) {
+        out.push_back(static_cast<uint8_t>(x) | 0x80);
+        x >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(x));
+}
+
+// Read a varint written by put_varint and advance pos
+// Returns false if the varint runs past the end of the buffer
+inline bool
+get_varint(const uint8_t*& pos, const uint8_t* end, int64_t& value)
+{
+    uint64_t x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos == end) { return false; }
+        uint8_t byte = *pos++;
+        x |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = zigzag_decode(x);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // end namespace DynoGraph
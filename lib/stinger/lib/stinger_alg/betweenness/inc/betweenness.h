@@ -6,6 +6,23 @@
 #include "stinger_core/xmalloc.h"
 #include "stinger_core/stinger_error.h"
 
+/*
+ * Runs Brandes searches from many sources, reusing one workspace per thread between searches and calls.
+ * Create one with bc_engine_new for the largest graph it will search, and free it with bc_engine_free.
+ */
+typedef struct bc_engine bc_engine_t;
+bc_engine_t * bc_engine_new(int64_t max_nv);
+void bc_engine_free(bc_engine_t * engine);
+/* Sets bc to the sum of the dependencies on each vertex from each source, and found_count to the number of sources that reached it */
+void bc_engine_search(bc_engine_t * engine, stinger_t * S, int64_t nv, int64_t nsamples, const int64_t * sources, double * bc, int64_t * found_count);
+/*
+ * Instead of summing over the sources, sets distances[s] to the distance of each vertex from sources[s] (-1 if not found)
+ * and dependencies[s] to the dependency of sources[s] on each vertex. Each array must hold nv entries.
+ */
+void bc_engine_search_each(bc_engine_t * engine, stinger_t * S, int64_t nv, int64_t nsamples, const int64_t * sources,
+                           int64_t ** distances, double ** dependencies);
+
+/* These use an engine sized for S that is kept between calls, so they must not be called from more than one thread at a time */
 void single_bc_search(stinger_t * S, int64_t nv, int64_t source, double * bc, int64_t * found_count);
 void sample_search_custom(stinger_t * S, int64_t nv, int64_t nsamples, int64_t * vertices_to_sample, double * bc, int64_t * found_count);
 void sample_search(stinger_t * S, int64_t nv, int64_t nsamples, double * bc, int64_t * found_count);
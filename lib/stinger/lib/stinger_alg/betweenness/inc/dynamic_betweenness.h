@@ -7,10 +7,19 @@
 #include <vector>
 #include "stinger_net/stinger_alg.h"
 #include "streaming_algorithm.h"
+#include "pending_edges.h"
 namespace gt {
   namespace stinger {
     class BetweennessCentrality : public IDynamicGraphAlgorithm
     {
+    public:
+        enum Mode {
+            // Search from every sampled source each epoch
+            RECOMPUTE,
+            // Keep the distances and dependencies from up to source_budget sources between epochs,
+            // and only search again from the ones whose shortest paths were changed by the edges inserted and deleted
+            INCREMENTAL
+        };
     private:
         double * bc;
         int64_t * times_found;
@@ -20,8 +29,25 @@ namespace gt {
         double old_weighting;
 
         std::vector<int64_t> vertices_to_sample;
+        // Workspace for the searches, kept between epochs
+        struct bc_engine * engine;
+        void search(stinger_registered_alg * alg, double * result);
+
+        Mode mode;
+        // Most sources to keep search results for in incremental mode, each costs two arrays of max_nv entries
+        int64_t source_budget;
+        // Search results kept for each source, slot i holds the results from tracked_sources[i] (-1 if unused)
+        std::vector<int64_t> tracked_sources;
+        std::vector<int64_t *> tracked_distances;
+        std::vector<double *> tracked_dependencies;
+        // Edges changed since the last onPost, for incremental mode
+        PendingEdges pending;
+        void searchIncremental(stinger_registered_alg * alg, double * result);
+        // Returns true if an edge change may have altered the shortest paths from the source in this slot
+        bool isAffected(int64_t slot);
     public:
-        BetweennessCentrality(int64_t num_samples, double weighting, uint8_t do_weighted);
+        BetweennessCentrality(int64_t num_samples, double weighting, uint8_t do_weighted,
+            Mode mode = RECOMPUTE, int64_t source_budget = 32);
         ~BetweennessCentrality();
 
         void setSources(const std::vector<int64_t> &sources);
@@ -1,145 +1,336 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "stinger_core/stinger.h"
 #include "stinger_core/stinger_atomics.h"
 #include "stinger_core/xmalloc.h"
 #include "stinger_core/stinger_error.h"
 #include "betweenness.h"
+#include "local_queue.h"
 
-#define PHASE_END -1
+/*
+ * Engines sized for more vertices than this search one source at a time using every thread,
+ * instead of giving each thread its own source (and its own copy of the workspace)
+ */
+#define BC_COARSE_MAX_VERTICES (1 << 22)
 
-void 
-single_bc_search(stinger_t * S, int64_t nv, int64_t source, double * bc, int64_t * found_count)
-{
-
-    int64_t * paths = (int64_t * )xcalloc(nv * 3, sizeof(int64_t));
-    int64_t * bfs_stack = paths + nv;
-    double * partial = (double *)xcalloc(nv, sizeof(double));
+/* Everything one search needs. Arrays are reset after each search, touching only the vertices that were found */
+struct bc_workspace {
+    int64_t * d;            /* distance from the source, -1 if not found yet */
+    int64_t * paths;        /* number of shortest paths from the source */
+    double * partial;       /* dependency of the source on each vertex */
+    int64_t * stack;        /* vertices in the order they were found */
+    int64_t * level_start;  /* where each level begins in stack */
+};
 
-    int64_t * d = (int64_t *)xmalloc(nv * sizeof(int64_t));
+struct bc_engine {
+    int64_t max_nv;
+    int64_t num_workspaces;
+    /* One per thread, allocated the first time that thread needs it */
+    struct bc_workspace * workspaces;
+};
 
-    if (paths == NULL || partial == NULL || d == NULL) {
-        LOG_E("Could not allocate memory for BC search");
-        return;
-    }
+static int64_t
+max_threads (void)
+{
+#if defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
 
-    for(int64_t i = 0; i < nv; i ++) d[i] = -1;
+static void
+workspace_init (struct bc_workspace * ws, int64_t max_nv, int fine_grained)
+{
+    ws->d = (int64_t *)xmalloc(max_nv * sizeof(int64_t));
+    ws->paths = (int64_t *)xmalloc(max_nv * sizeof(int64_t));
+    ws->partial = (double *)xmalloc(max_nv * sizeof(double));
+    ws->stack = (int64_t *)xmalloc(max_nv * sizeof(int64_t));
+    /* One entry per level, plus the end of the last level and the empty level after it */
+    ws->level_start = (int64_t *)xmalloc((max_nv + 2) * sizeof(int64_t));
 
-    int64_t stack_top = 2;
-    bfs_stack[0] = source;
-    bfs_stack[1] = PHASE_END;
-    d[source] = 0;
-    paths[source] = 1;
-    int64_t count = 1;
+    /* Initialize on the thread(s) that will use the workspace */
+    OMP("omp parallel for if(fine_grained)")
+    for (int64_t v = 0; v < max_nv; v++) {
+        ws->d[v] = -1;
+        ws->paths[v] = 0;
+        ws->partial[v] = 0;
+    }
+}
 
-    int64_t index = -1;
+static void
+workspace_free (struct bc_workspace * ws)
+{
+    xfree(ws->d);
+    xfree(ws->paths);
+    xfree(ws->partial);
+    xfree(ws->stack);
+    xfree(ws->level_start);
+}
 
-    //LOG_D("Directed");
+static struct bc_workspace *
+get_workspace (bc_engine_t * engine, int64_t index, int fine_grained)
+{
+    struct bc_workspace * ws = &engine->workspaces[index];
+    if (ws->d == NULL) {
+        workspace_init(ws, engine->max_nv, fine_grained);
+    }
+    return ws;
+}
 
-    while (count > 0) {
-        count = 0;
-        index++;
+bc_engine_t *
+bc_engine_new (int64_t max_nv)
+{
+    bc_engine_t * engine = (bc_engine_t *)xmalloc(sizeof(bc_engine_t));
+    engine->max_nv = max_nv;
+    engine->num_workspaces = max_threads();
+    engine->workspaces = (struct bc_workspace *)xcalloc(engine->num_workspaces, sizeof(struct bc_workspace));
+    return engine;
+}
 
-        while (bfs_stack[index] != PHASE_END) {
-            int64_t v = bfs_stack[index];
-            int64_t d_next = d[v] + 1;
+void
+bc_engine_free (bc_engine_t * engine)
+{
+    if (engine == NULL) return;
+    for (int64_t i = 0; i < engine->num_workspaces; i++) {
+        workspace_free(&engine->workspaces[i]);
+    }
+    xfree(engine->workspaces);
+    xfree(engine);
+}
 
-            //LOG_D_A("(%ld) TOS=%ld",source,v);
+/*
+ * Brandes' algorithm from a single source, adding the dependencies to bc and counting the vertices found in found_count.
+ * If distance and dependency are set, the distance and dependency of each vertex found are also copied there.
+ * Any of these may be NULL.
+ * With fine_grained set, every thread works on each level of this search.
+ * Otherwise the search runs on the calling thread, and other searches may be adding to bc at the same time.
+ */
+static void
+bc_search (stinger_t * S, struct bc_workspace * ws, int64_t source, double * bc, int64_t * found_count,
+           int64_t * distance, double * dependency, int fine_grained)
+{
+    int64_t * d = ws->d;
+    int64_t * paths = ws->paths;
+    double * partial = ws->partial;
+    int64_t * stack = ws->stack;
+    int64_t * level_start = ws->level_start;
 
-            STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, v) {
-                //LOG_D_A("(%ld) Begin - d[%ld]=%ld paths[%ld]=%ld",source,STINGER_EDGE_DEST,d[STINGER_EDGE_DEST],STINGER_EDGE_DEST,paths[STINGER_EDGE_DEST]);
-                if(d[STINGER_EDGE_DEST] < 0) {
-                    d[STINGER_EDGE_DEST]     = d_next;
-                    paths[STINGER_EDGE_DEST] = paths[v];
-                    count = count + 1;
-                    bfs_stack[stack_top++]           = STINGER_EDGE_DEST;
+    stack[0] = source;
+    d[source] = 0;
+    paths[source] = 1;
+    level_start[0] = 0;
+    level_start[1] = 1;
+    int64_t stack_top = 1;
+    int64_t nlevels = 1;
 
-                    stinger_int64_fetch_add(found_count + STINGER_EDGE_DEST, 1);
-                }
-                else if(d[STINGER_EDGE_DEST] == d_next) {
-                    paths[STINGER_EDGE_DEST] += paths[v];
-                }
-                //LOG_D_A("(%ld) End - d[%ld]=%ld paths[%ld]=%ld",source,STINGER_EDGE_DEST,d[STINGER_EDGE_DEST],STINGER_EDGE_DEST,paths[STINGER_EDGE_DEST]);
+    /* Find each level of the search tree, counting shortest paths as we go */
+    while (level_start[nlevels] > level_start[nlevels-1]) {
+        const int64_t start = level_start[nlevels-1];
+        const int64_t end = level_start[nlevels];
+        const int64_t d_next = nlevels;
 
-            } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+        OMP("omp parallel if(fine_grained)")
+        {
+            int64_t local[LOCAL_QUEUE_SIZE];
+            int64_t nlocal = 0;
 
-            index++;
+            OMP("omp for schedule(dynamic, 64) nowait")
+            for (int64_t j = start; j < end; j++) {
+                const int64_t v = stack[j];
+                const int64_t paths_v = paths[v];
+                STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, v) {
+                    const int64_t w = STINGER_EDGE_DEST;
+                    int64_t dw = d[w];
+                    if (dw < 0) {
+                        /* whoever swaps in the distance first gets to push the vertex */
+                        dw = stinger_int64_cas(&d[w], -1, d_next);
+                        if (dw < 0) {
+                            dw = d_next;
+                            if (nlocal == LOCAL_QUEUE_SIZE) {
+                                flush_local_queue(stack, &stack_top, local, &nlocal);
+                            }
+                            local[nlocal++] = w;
+                            if (found_count) stinger_int64_fetch_add(found_count + w, 1);
+                        }
+                    }
+                    if (dw == d_next) {
+                        stinger_int64_fetch_add(&paths[w], paths_v);
+                    }
+                } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+            }
+            flush_local_queue(stack, &stack_top, local, &nlocal);
         }
-
-        bfs_stack[stack_top++] = PHASE_END;
+        level_start[++nlevels] = stack_top;
     }
-    stack_top--;
 
-    while (stack_top > 0) {
-        while (bfs_stack[stack_top] != PHASE_END) {
-            int64_t w = bfs_stack[stack_top];
+    /* Accumulate dependencies from the deepest level back up, skipping the source */
+    for (int64_t l = nlevels - 2; l > 0; l--) {
+        OMP("omp parallel for schedule(dynamic, 64) if(fine_grained)")
+        for (int64_t j = level_start[l]; j < level_start[l+1]; j++) {
+            const int64_t w = stack[j];
+            const int64_t sw = paths[w];
             double dsw = 0;
-            int64_t sw = paths[w];
             STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, w) {
-                if(d[w] == (d[STINGER_EDGE_DEST] - 1)) {
-                    dsw += frac(sw,paths[STINGER_EDGE_DEST]) * (1.0 + partial[STINGER_EDGE_DEST]);
+                if (d[STINGER_EDGE_DEST] == l + 1) {
+                    dsw += frac(sw, paths[STINGER_EDGE_DEST]) * (1.0 + partial[STINGER_EDGE_DEST]);
                 }
             } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
             partial[w] = dsw;
-            bc[w] += dsw;
-            stack_top--;
-            //LOG_D_A("(%ld) Sum Partials for %ld -- partial[%ld]=%lf bc[%ld]=%lf",source,w,w,partial[w],w,bc[w]);
+            /* Each vertex appears once per search, but other searches may be running */
+            if (bc && fine_grained) {
+                bc[w] += dsw;
+            } else if (bc) {
+                atomic_add_double(&bc[w], dsw);
+            }
         }
-        stack_top--;
     }
 
-    xfree(d);
-    xfree(partial);
-    xfree(paths);
+    /* Reset only the vertices we touched */
+    OMP("omp parallel for if(fine_grained)")
+    for (int64_t j = 0; j < stack_top; j++) {
+        const int64_t w = stack[j];
+        if (distance) {
+            distance[w] = d[w];
+            dependency[w] = partial[w];
+        }
+        d[w] = -1;
+        paths[w] = 0;
+        partial[w] = 0;
+    }
 }
 
-int64_t rand_vertex(int64_t nv) { return rand() % nv; }
-
-void sample_search(stinger_t * S, int64_t nv, int64_t nsamples, double * bc, int64_t * found_count)
+/*
+ * With enough sources to go around, each thread runs whole searches on its own.
+ * Otherwise (or when a workspace per thread would take too much memory) all threads work on each search.
+ * Workspaces hold max_nv vertices no matter how many are active, so that is what decides the memory use.
+ */
+static int
+use_coarse_search (const bc_engine_t * engine, int64_t nsamples)
 {
-    assert(0); // NOT IMPLEMENTED
-    //sample_search_custom(S, nv, nsamples, bc, found_count, &rand_vertex);
+    return nsamples >= engine->num_workspaces && engine->max_nv <= BC_COARSE_MAX_VERTICES;
 }
 
 void
-sample_search_custom(stinger_t * S, int64_t nv, int64_t nsamples, int64_t * vertices_to_sample, double * bc, int64_t * found_count)
+bc_engine_search (bc_engine_t * engine, stinger_t * S, int64_t nv, int64_t nsamples, const int64_t * sources,
+                  double * bc, int64_t * found_count)
 {
-    LOG_V_A("  > Beginning with %ld vertices and %ld samples\n", (long)nv, (long)nsamples);
-
-    OMP("omp parallel")
-    {
-        OMP("omp for")
-        for(int64_t v = 0; v < nv; v++) {
-            found_count[v] = 0;
-            bc[v] = 0;
-        }
-
-        double * partials = (double *)xcalloc(nv, sizeof(double));
+    if (nv > engine->max_nv) {
+        LOG_E_A("BC engine was created for %ld vertices, but the graph has %ld", (long)engine->max_nv, (long)nv);
+        return;
+    }
 
-        if(nv < nsamples) {
-            int64_t min = nv;
+    OMP("omp parallel for")
+    for (int64_t v = 0; v < nv; v++) {
+        found_count[v] = 0;
+        bc[v] = 0;
+    }
 
-            OMP("omp for")
-            for(int64_t s = 0; s < min; s++) {
-                single_bc_search(S, nv, s, partials, found_count);
-            }
-        } else {
-            OMP("omp for")
-            for(int64_t s = 0; s < nsamples; s++) {
-                int64_t v = vertices_to_sample[s];
-                single_bc_search(S, nv, v, partials, found_count);
+    if (use_coarse_search(engine, nsamples)) {
+        OMP("omp parallel num_threads(engine->num_workspaces)")
+        {
+            struct bc_workspace * ws = get_workspace(engine, omp_get_thread_num(), 0);
+            OMP("omp for schedule(dynamic, 1)")
+            for (int64_t s = 0; s < nsamples; s++) {
+                bc_search(S, ws, sources[s], bc, found_count, NULL, NULL, 0);
             }
         }
+    } else {
+        struct bc_workspace * ws = get_workspace(engine, 0, 1);
+        for (int64_t s = 0; s < nsamples; s++) {
+            bc_search(S, ws, sources[s], bc, found_count, NULL, NULL, 1);
+        }
+    }
+}
 
-        OMP("omp critical")
+void
+bc_engine_search_each (bc_engine_t * engine, stinger_t * S, int64_t nv, int64_t nsamples, const int64_t * sources,
+                       int64_t ** distances, double ** dependencies)
+{
+    if (nv > engine->max_nv) {
+        LOG_E_A("BC engine was created for %ld vertices, but the graph has %ld", (long)engine->max_nv, (long)nv);
+        return;
+    }
+
+    if (use_coarse_search(engine, nsamples)) {
+        OMP("omp parallel num_threads(engine->num_workspaces)")
         {
-            for(int64_t v = 0; v < nv; v++) {
-                bc[v] += partials[v];
+            struct bc_workspace * ws = get_workspace(engine, omp_get_thread_num(), 0);
+            OMP("omp for schedule(dynamic, 1)")
+            for (int64_t s = 0; s < nsamples; s++) {
+                for (int64_t v = 0; v < nv; v++) {
+                    distances[s][v] = -1;
+                    dependencies[s][v] = 0;
+                }
+                bc_search(S, ws, sources[s], NULL, NULL, distances[s], dependencies[s], 0);
+            }
+        }
+    } else {
+        struct bc_workspace * ws = get_workspace(engine, 0, 1);
+        for (int64_t s = 0; s < nsamples; s++) {
+            OMP("omp parallel for")
+            for (int64_t v = 0; v < nv; v++) {
+                distances[s][v] = -1;
+                dependencies[s][v] = 0;
             }
+            bc_search(S, ws, sources[s], NULL, NULL, distances[s], dependencies[s], 1);
         }
+    }
+}
+
+/*
+ * Engine for the functions below, which don't take one. Kept between calls, and only replaced to fit a larger graph.
+ * These functions must not be called from more than one thread at a time.
+ */
+static bc_engine_t * shared_engine = NULL;
+
+static bc_engine_t *
+get_shared_engine (stinger_t * S)
+{
+    int64_t max_nv = S->max_nv;
+    if (shared_engine == NULL || shared_engine->max_nv < max_nv) {
+        bc_engine_free(shared_engine);
+        shared_engine = bc_engine_new(max_nv);
+    }
+    return shared_engine;
+}
+
+void
+single_bc_search(stinger_t * S, int64_t nv, int64_t source, double * bc, int64_t * found_count)
+{
+    bc_search(S, get_workspace(get_shared_engine(S), 0, 1), source, bc, found_count, NULL, NULL, 1);
+}
+
+int64_t rand_vertex(int64_t nv) { return rand() % nv; }
+
+void sample_search(stinger_t * S, int64_t nv, int64_t nsamples, double * bc, int64_t * found_count)
+{
+    /* Search from every vertex if there are enough samples, otherwise pick sources at random */
+    int64_t count = nsamples < nv ? nsamples : nv;
+    int64_t * vertices_to_sample = (int64_t *)xmalloc(count * sizeof(int64_t));
+    for (int64_t s = 0; s < count; s++) {
+        vertices_to_sample[s] = nsamples < nv ? rand_vertex(nv) : s;
+    }
+    sample_search_custom(S, nv, count, vertices_to_sample, bc, found_count);
+    xfree(vertices_to_sample);
+}
+
+void
+sample_search_custom(stinger_t * S, int64_t nv, int64_t nsamples, int64_t * vertices_to_sample, double * bc, int64_t * found_count)
+{
+    LOG_V_A("  > Beginning with %ld vertices and %ld samples\n", (long)nv, (long)nsamples);
 
-        free(partials);
+    bc_engine_t * engine = get_shared_engine(S);
+    if (nv < nsamples) {
+        /* Search from every vertex */
+        int64_t * all_vertices = (int64_t *)xmalloc(nv * sizeof(int64_t));
+        for (int64_t v = 0; v < nv; v++) { all_vertices[v] = v; }
+        bc_engine_search(engine, S, nv, nv, all_vertices, bc, found_count);
+        xfree(all_vertices);
+    } else {
+        bc_engine_search(engine, S, nv, nsamples, vertices_to_sample, bc, found_count);
     }
 }
@@ -12,6 +12,9 @@ extern "C" {
 }
 #include "dynamic_betweenness.h"
 
+#include <algorithm>
+#include <hooks.h>
+
 using namespace gt::stinger;
 
 void
@@ -20,7 +23,10 @@ BetweennessCentrality::setSources(const std::vector<int64_t> &sources) {
 }
 
 std::string
-BetweennessCentrality::getName() { return "betweenness_centrality"; }
+BetweennessCentrality::getName()
+{
+    return mode == INCREMENTAL ? "betweenness_centrality_updating" : "betweenness_centrality";
+}
 
 int64_t
 BetweennessCentrality::getDataPerVertex() { return sizeof(int64_t) + sizeof(double); }
@@ -28,8 +34,12 @@ BetweennessCentrality::getDataPerVertex() { return sizeof(int64_t) + sizeof(doub
 std::string
 BetweennessCentrality::getDataDescription() { return "dl bc times_found"; }
 
-BetweennessCentrality::BetweennessCentrality(int64_t num_samples, double weighting, uint8_t do_weighted)
+BetweennessCentrality::BetweennessCentrality(int64_t num_samples, double weighting, uint8_t do_weighted,
+    Mode mode, int64_t source_budget)
 : vertices_to_sample(num_samples)
+, engine(NULL)
+, mode(mode)
+, source_budget(source_budget)
 {
     this->weighting = weighting;
     old_weighting = 1 - weighting;
@@ -39,10 +49,10 @@ BetweennessCentrality::BetweennessCentrality(int64_t num_samples, double weighti
 void
 BetweennessCentrality::onInit(stinger_registered_alg * alg)
 {
-    int64_t nv = alg->max_active_vertex + 1;
     bc = (double *)alg->alg_data;
     times_found = (int64_t *)(bc + alg->stinger->max_nv);
     sample_bc = NULL;
+    engine = bc_engine_new(alg->stinger->max_nv);
 
     if(do_weighted) {
         sample_bc = (double *)xcalloc(sizeof(double), alg->stinger->max_nv);
@@ -50,14 +60,156 @@ BetweennessCentrality::onInit(stinger_registered_alg * alg)
 
     if (alg->max_active_vertex > 0)
     {
-        sample_search_custom(alg->stinger, nv, vertices_to_sample.size(), vertices_to_sample.data(), bc, times_found);
+        search(alg, bc);
+    }
+}
+
+void
+BetweennessCentrality::search(stinger_registered_alg * alg, double * result)
+{
+    if (mode == INCREMENTAL) {
+        searchIncremental(alg, result);
+        return;
+    }
+    int64_t nv = alg->max_active_vertex + 1;
+    // Use every vertex as a source if there are more samples than vertices
+    if (nv < static_cast<int64_t>(vertices_to_sample.size())) {
+        std::vector<int64_t> all_vertices(nv);
+        for (int64_t v = 0; v < nv; v++) { all_vertices[v] = v; }
+        bc_engine_search(engine, alg->stinger, nv, nv, all_vertices.data(), result, times_found);
+    } else {
+        bc_engine_search(engine, alg->stinger, nv, vertices_to_sample.size(), vertices_to_sample.data(), result, times_found);
+    }
+}
+
+void
+BetweennessCentrality::searchIncremental(stinger_registered_alg * alg, double * result)
+{
+    stinger_t * S = alg->stinger;
+    int64_t nv = alg->max_active_vertex + 1;
+    int64_t max_nv = S->max_nv;
+
+    // When no batch has been inserted since the last run (another alg trial), the kept results are up to date
+    bool graph_changed = pending.consume();
+
+    // Use every vertex as a source if there are more samples than vertices
+    std::vector<int64_t> sources;
+    if (nv < static_cast<int64_t>(vertices_to_sample.size())) {
+        for (int64_t v = 0; v < nv; v++) { sources.push_back(v); }
+    } else {
+        sources = vertices_to_sample;
+    }
+
+    // Keep results for the first source_budget sources, and search from the rest every time
+    int64_t num_tracked = std::min<int64_t>(source_budget, sources.size());
+    std::vector<int64_t> untracked(sources.begin() + num_tracked, sources.end());
+
+    // Match each tracked source with the slot that already has its results, if any
+    if (static_cast<int64_t>(tracked_sources.size()) < num_tracked) {
+        tracked_sources.resize(num_tracked, -1);
+        tracked_distances.resize(num_tracked, NULL);
+        tracked_dependencies.resize(num_tracked, NULL);
+    }
+    int64_t num_slots = tracked_sources.size();
+    std::vector<int64_t> slot_of(num_tracked, -1);
+    std::vector<bool> slot_used(num_slots, false);
+    for (int64_t i = 0; i < num_tracked; ++i) {
+        for (int64_t slot = 0; slot < num_slots; ++slot) {
+            if (!slot_used[slot] && tracked_sources[slot] == sources[i]) {
+                slot_of[i] = slot;
+                slot_used[slot] = true;
+                break;
+            }
+        }
+    }
+    // Sources we haven't seen before get the slots left over from sources that are no longer sampled
+    std::vector<int64_t> stale;
+    for (int64_t i = 0, slot = 0; i < num_tracked; ++i) {
+        if (slot_of[i] >= 0) { continue; }
+        while (slot_used[slot]) { ++slot; }
+        slot_of[i] = slot;
+        slot_used[slot] = true;
+        tracked_sources[slot] = sources[i];
+        if (tracked_distances[slot] == NULL) {
+            tracked_distances[slot] = (int64_t *)xmalloc(sizeof(int64_t) * max_nv);
+            tracked_dependencies[slot] = (double *)xmalloc(sizeof(double) * max_nv);
+            OMP("omp parallel for")
+            for (int64_t v = 0; v < max_nv; v++) {
+                tracked_distances[slot][v] = -1;
+                tracked_dependencies[slot][v] = 0;
+            }
+        }
+        stale.push_back(slot);
+    }
+
+    // Search again from every source whose shortest paths may have changed
+    bool all_affected = !pending.complete();
+    if (graph_changed) {
+        std::vector<int64_t> kept;
+        for (int64_t i = 0; i < num_tracked; ++i) {
+            if (std::find(stale.begin(), stale.end(), slot_of[i]) == stale.end()) { kept.push_back(slot_of[i]); }
+        }
+        std::vector<int64_t> affected(kept.size(), 0);
+        OMP("omp parallel for schedule(dynamic, 1)")
+        for (size_t i = 0; i < kept.size(); ++i) {
+            affected[i] = all_affected || isAffected(kept[i]);
+        }
+        for (size_t i = 0; i < kept.size(); ++i) {
+            if (affected[i]) { stale.push_back(kept[i]); }
+        }
     }
+    std::vector<int64_t> stale_sources;
+    std::vector<int64_t *> stale_distances;
+    std::vector<double *> stale_dependencies;
+    for (int64_t slot : stale) {
+        stale_sources.push_back(tracked_sources[slot]);
+        stale_distances.push_back(tracked_distances[slot]);
+        stale_dependencies.push_back(tracked_dependencies[slot]);
+    }
+    bc_engine_search_each(engine, S, nv, stale_sources.size(), stale_sources.data(),
+        stale_distances.data(), stale_dependencies.data());
+
+    // Sum up the sources we don't keep results for, then add the ones we do
+    bc_engine_search(engine, S, nv, untracked.size(), untracked.data(), result, times_found);
+    OMP("omp parallel for")
+    for (int64_t v = 0; v < nv; v++) {
+        for (int64_t i = 0; i < num_tracked; ++i) {
+            int64_t slot = slot_of[i];
+            result[v] += tracked_dependencies[slot][v];
+            // The source itself doesn't count as found
+            if (tracked_distances[slot][v] > 0) { times_found[v] += 1; }
+        }
+    }
+
+    Hooks &hooks = Hooks::getInstance();
+    hooks.set_stat("bc_tracked_sources", num_tracked);
+    hooks.set_stat("bc_updated_sources", static_cast<int64_t>(stale.size()));
+    hooks.set_stat("bc_untracked_sources", static_cast<int64_t>(untracked.size()));
+}
+
+bool
+BetweennessCentrality::isAffected(int64_t slot)
+{
+    const int64_t * d = tracked_distances[slot];
+    // An inserted edge changes the shortest paths if it leads to a vertex that was farther than one level away,
+    // or adds another path to a vertex on the next level
+    for (const stinger_edge_update &e : pending.insertions) {
+        int64_t du = d[e.source], dv = d[e.destination];
+        if (du >= 0 && (dv < 0 || dv > du)) { return true; }
+    }
+    // A deleted edge only matters if it was on a shortest path
+    for (const stinger_edge_update &e : pending.deletions) {
+        int64_t du = d[e.source], dv = d[e.destination];
+        if (du >= 0 && dv == du + 1) { return true; }
+    }
+    return false;
 }
 
 void
 BetweennessCentrality::onPre(stinger_registered_alg * alg)
 {
-    /* nothing to do */
+    if (mode != INCREMENTAL) { return; }
+    pending.collect(alg);
 }
 
 void
@@ -66,19 +218,25 @@ BetweennessCentrality::onPost(stinger_registered_alg * alg)
     int64_t nv = alg->max_active_vertex + 1;
 
     if(do_weighted) {
-        sample_search_custom(alg->stinger, nv, vertices_to_sample.size(), vertices_to_sample.data(), bc, times_found);
+        // Blend this epoch's scores with the ones from the previous epoch
+        search(alg, sample_bc);
 
         OMP("omp parallel for")
         for(int64_t v = 0; v < nv; v++) {
             bc[v] = bc[v] * old_weighting + weighting* sample_bc[v];
         }
     } else {
-        sample_search_custom(alg->stinger, nv, vertices_to_sample.size(), vertices_to_sample.data(), bc, times_found);
+        search(alg, bc);
     }
 }
 
 BetweennessCentrality::~BetweennessCentrality()
 {
+    bc_engine_free(engine);
+    for (size_t slot = 0; slot < tracked_sources.size(); ++slot) {
+        xfree(tracked_distances[slot]);
+        xfree(tracked_dependencies[slot]);
+    }
     if(do_weighted) {
         xfree(sample_bc);
     }
@@ -5,26 +5,67 @@
 #include "stinger_core/xmalloc.h"
 #include "stinger_core/stinger_error.h"
 
+/*
+ * Visited vertices are claimed with a compare-and-swap on level, and each thread buffers the vertices it
+ * discovers before appending them to the queue.
+ * queue holds nv entries and Qhead holds nv + 2 (the start of each level's frontier in the queue).
+ * Returns the number of steps taken plus one.
+ */
 int64_t
 parallel_breadth_first_search (
     struct stinger * S,
     int64_t nv,
     int64_t source,
-    int64_t * marks,
     int64_t * queue,
     int64_t * Qhead,
     int64_t * level
 );
 
+/* Default thresholds for switching between top-down and bottom-up steps (Beamer et al.) */
+#define BFS_DEFAULT_ALPHA 14.0
+#define BFS_DEFAULT_BETA 24.0
+
+/*
+ * Switches to bottom-up steps (each unvisited vertex scans its in-edges for a parent in the frontier)
+ * when the frontier has more than 1/alpha of the unexplored edges, and back to top-down steps
+ * when the frontier shrinks below nv/beta vertices.
+ * queue and Qhead are the same as for parallel_breadth_first_search, frontier_bits holds (nv + 63) / 64 words.
+ * If directions is not NULL (nv entries), it receives 'T' or 'B' for the step that expanded each level.
+ */
 int64_t
 direction_optimizing_parallel_breadth_first_search (
     struct stinger * S,
     int64_t nv,
     int64_t source,
-    int64_t * marks,
     int64_t * queue,
     int64_t * Qhead,
-    int64_t * level
+    int64_t * level,
+    uint64_t * frontier_bits,
+    double alpha,
+    double beta,
+    char * directions
+);
+
+/* Maximum number of searches that multi_source_breadth_first_search can run at once */
+#define MSBFS_MAX_SOURCES 64
+
+/*
+ * Runs a breadth-first search from each of the sources at the same time, sharing each adjacency list scan.
+ * Each vertex has a bit for each search in seen, frontier and next (each of length nv).
+ * level receives the distances from the last source.
+ * If all_levels is not NULL, it receives the distances from every source (nv * num_sources, one source after another).
+ */
+int64_t
+multi_source_breadth_first_search (
+    struct stinger * S,
+    int64_t nv,
+    const int64_t * sources,
+    int64_t num_sources,
+    uint64_t * seen,
+    uint64_t * frontier,
+    uint64_t * next,
+    int64_t * level,
+    int64_t * all_levels
 );
 
 #endif
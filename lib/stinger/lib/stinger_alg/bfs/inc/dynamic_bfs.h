@@ -7,15 +7,57 @@
 #include <vector>
 #include "stinger_net/stinger_alg.h"
 #include "streaming_algorithm.h"
+#include "pending_edges.h"
+extern "C" {
+#include "stinger_alg/bfs.h"
+}
 namespace gt {
   namespace stinger {
     class BreadthFirstSearch : public IDynamicGraphAlgorithm
     {
+    public:
+        enum Mode {
+            // Expand each level from the frontier's out-edges
+            TOP_DOWN,
+            // Switch between top-down and bottom-up steps depending on the size of the frontier
+            DIRECTION_OPTIMIZING,
+            // Search from up to 64 sources at once, instead of one after another
+            MULTI_SOURCE,
+            // Repair the levels from the previous epoch using the edges inserted and deleted since then
+            // Only searches from the last source
+            INCREMENTAL
+        };
     private:
         int64_t *level;
+        // Workspace, allocated once in onInit for max_nv vertices and reused by every search
+        int64_t *queue;
+        int64_t *Qhead;
+        uint64_t *frontier_bits;
+        char *directions;
+        uint64_t *seen;
+        uint64_t *frontier;
+        uint64_t *next;
         std::vector<int64_t> sources;
+        Mode mode;
+        // Thresholds for direction-optimizing search
+        double alpha;
+        double beta;
+        // Incremental search falls back to a full search once this fraction of the vertices are affected
+        double max_affected_fraction;
+        // Edges changed since the last onPost, for incremental search
+        PendingEdges pending;
+        // Levels from here up to max_nv are known to be -1, so they don't need to be reset again
+        int64_t unreached_from;
+        void searchEachSource(stinger_registered_alg * alg);
+        void searchMultiSource(stinger_registered_alg * alg);
+        void searchIncremental(stinger_registered_alg * alg);
+        // Returns false if the levels could not be repaired and must be recomputed
+        bool repairLevels(stinger_registered_alg * alg, int64_t source, int64_t &num_affected);
     public:
-        BreadthFirstSearch();
+        BreadthFirstSearch(Mode mode = DIRECTION_OPTIMIZING,
+            double alpha = BFS_DEFAULT_ALPHA, double beta = BFS_DEFAULT_BETA,
+            double max_affected_fraction = 0.1);
+        ~BreadthFirstSearch();
 
         void setSources(const std::vector<int64_t> &sources);
 
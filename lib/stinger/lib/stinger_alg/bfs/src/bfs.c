@@ -2,22 +2,49 @@
 
 #include "stinger_core/x86_full_empty.h"
 
+#include "local_queue.h"
+
+/* Expands the frontier queue[Qstart..Qend) along out-edges, queueing newly discovered vertices at level nQ */
+static void
+top_down_step (struct stinger * S, int64_t * queue, int64_t Qstart, int64_t Qend,
+               int64_t * Qnext, int64_t * level, int64_t nQ)
+{
+    OMP ("omp parallel")
+    {
+        int64_t local[LOCAL_QUEUE_SIZE];
+        int64_t nlocal = 0;
+
+        OMP ("omp for schedule(dynamic, 64) nowait")
+        for (int64_t j = Qstart; j < Qend; j++) {
+            STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN (S, queue[j]) {
+                const int64_t v = STINGER_EDGE_DEST;
+                /* whoever swaps in the new level first gets to queue the vertex */
+                if (level[v] < 0 && stinger_int64_cas(&level[v], -1, nQ) == -1) {
+                    if (nlocal == LOCAL_QUEUE_SIZE) {
+                        flush_local_queue(queue, Qnext, local, &nlocal);
+                    }
+                    local[nlocal++] = v;
+                }
+            } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+        }
+        flush_local_queue(queue, Qnext, local, &nlocal);
+    }
+}
+
 int64_t
 parallel_breadth_first_search (struct stinger * S, int64_t nv,
-                            int64_t source, int64_t * marks,
-                    int64_t * queue, int64_t * Qhead, int64_t * level)
+                            int64_t source, int64_t * queue,
+                            int64_t * Qhead, int64_t * level)
 {
     OMP("omp parallel for")
     for (int64_t i = 0; i < nv; i++) {
         level[i] = -1;
-        marks[i] = 0;
     }
 
     int64_t nQ, Qnext, Qstart, Qend;
     /* initialize */
     queue[0] = source;
     level[source] = 0;
-    marks[source] = 1;
     Qnext = 1;    /* next open slot in the queue */
     nQ = 1;         /* level we are currently processing */
     Qhead[0] = 0;    /* beginning of the current frontier */
@@ -27,24 +54,12 @@ parallel_breadth_first_search (struct stinger * S, int64_t nv,
     Qend = Qhead[nQ];
 
     while (Qstart != Qend) {
-        OMP ("omp parallel for")
-        for (int64_t j = Qstart; j < Qend; j++) {
-            STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN (S, queue[j]) {
-                int64_t d = level[STINGER_EDGE_DEST];
-                if (d < 0) {
-                    if (stinger_int64_fetch_add (&marks[STINGER_EDGE_DEST], 1) == 0) {
-                        level[STINGER_EDGE_DEST] = nQ;
-
-                        int64_t mine = stinger_int64_fetch_add(&Qnext, 1);
-                        queue[mine] = STINGER_EDGE_DEST;
-                    }
-                }
-            } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
-        }
+        top_down_step(S, queue, Qstart, Qend, &Qnext, level, nQ);
 
+        /* the next frontier is everything queued during this step */
+        Qhead[++nQ] = Qnext;
         Qstart = Qhead[nQ-1];
-        Qend = Qnext;
-        Qhead[nQ++] = Qend;
+        Qend = Qhead[nQ];
     }
 
     return nQ;
@@ -52,24 +67,26 @@ parallel_breadth_first_search (struct stinger * S, int64_t nv,
 
 int64_t
 direction_optimizing_parallel_breadth_first_search (struct stinger * S, int64_t nv,
-                      int64_t source, int64_t * marks,
-                      int64_t * queue, int64_t * Qhead, int64_t * level)
+                      int64_t source, int64_t * queue, int64_t * Qhead, int64_t * level,
+                      uint64_t * frontier_bits, double alpha, double beta,
+                      char * directions)
 {
-    for (int64_t i = 0; i < nv; i++) {
-        level[i] = -1;
-        marks[i] = 0;
-    }
-
     int64_t nQ, Qnext, Qstart, Qend;
     int64_t mf = 0;  /* number of edges incident on frontier */
     int64_t nf = 0;  /* number of vertices in frontier */
     int64_t mu = 0;  /* number of edges incident on unexplored vertices */
     int64_t nf_last = 0;  /* size of previous frontier */
+    const int64_t nwords = (nv + 63) / 64;
+
+    OMP("omp parallel for reduction(+:mu)")
+    for (int64_t i = 0; i < nv; i++) {
+        level[i] = -1;
+        mu += stinger_outdegree_get(S, i);
+    }
 
     /* initialize */
     queue[0] = source;
     level[source] = 0;
-    marks[source] = 1;
     Qnext = 1;  /* next open slot in the queue */
     nQ = 1;     /* level we are currently processing */
     Qhead[0] = 0;  /* beginning of the current frontier */
@@ -78,76 +95,86 @@ direction_optimizing_parallel_breadth_first_search (struct stinger * S, int64_t
     Qstart = Qhead[nQ-1];
     Qend = Qhead[nQ];
 
-    mf = 0;
-    nf = 0;
-    mu = stinger_total_edges(S);
-    //printf("mf: %ld, nf: %ld, mu: %ld, nf_last: %ld\n", mf, nf, mu, nf_last);
+    nf = 1;
+    mf = stinger_outdegree_get(S, source);
+    mu -= mf;
 
     int64_t top_down = 1;
 
     while (Qstart != Qend) {
+        if (directions) directions[nQ-1] = top_down ? 'T' : 'B';
+
         if (top_down) {
             /* forward (top down) traversal */
-            OMP ("omp parallel for")
-            for (int64_t j = Qstart; j < Qend; j++) {
-                STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN (S, queue[j]) {
-                    int64_t d = level[STINGER_EDGE_DEST];
-                    if (d < 0) {
-                        if (stinger_int64_fetch_add (&marks[STINGER_EDGE_DEST], 1) == 0) {
-                            level[STINGER_EDGE_DEST] = nQ;
-
-                            int64_t mine = stinger_int64_fetch_add(&Qnext, 1);
-                            queue[mine] = STINGER_EDGE_DEST;
-                        }
-                    }
-                } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
-            }
+            top_down_step(S, queue, Qstart, Qend, &Qnext, level, nQ);
         } else {
-            /* reverse (bottom up) traversal */
+            /* build a bitmap of the frontier, 64 vertices at a time so no atomics are needed */
             OMP ("omp parallel for")
-            for (int64_t i = 0; i < nv; i++) {
-                int64_t done = 0;
-                /* only process unvisited vertices */
-                if (!marks[i]) {
-                    STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN (S, i) {
-                        /* neighbor has been visited */
-                        if (!done && level[STINGER_EDGE_DEST] == nQ-1) {
-                            level[i] = nQ;
-                            marks[i] = 1;
-
-                            /* if we don't queue here, we cannot restart the forward search */
-                            int64_t mine = stinger_int64_fetch_add(&Qnext, 1);
-                            queue[mine] = i;
-                            done = 1;
-                        }
-                    } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+            for (int64_t w = 0; w < nwords; w++) {
+                uint64_t bits = 0;
+                const int64_t end = (w + 1) * 64 < nv ? (w + 1) * 64 : nv;
+                for (int64_t i = w * 64; i < end; i++) {
+                    if (level[i] == nQ-1) bits |= 1ULL << (i & 63);
                 }
+                frontier_bits[w] = bits;
+            }
+
+            /* reverse (bottom up) traversal: each unvisited vertex looks for a parent in the frontier */
+            OMP ("omp parallel")
+            {
+                int64_t local[LOCAL_QUEUE_SIZE];
+                int64_t nlocal = 0;
+
+                OMP ("omp for schedule(dynamic, 256) nowait")
+                for (int64_t i = 0; i < nv; i++) {
+                    /* only process unvisited vertices, no other thread writes level[i] during this step */
+                    if (level[i] < 0) {
+                        int64_t done = 0;
+                        STINGER_FORALL_IN_EDGES_OF_VTX_BEGIN (S, i) {
+                            /* stop scanning this edge block once a parent is found */
+                            if (done) break;
+                            const int64_t u = STINGER_EDGE_DEST;
+                            if (frontier_bits[u >> 6] & (1ULL << (u & 63))) {
+                                level[i] = nQ;
+
+                                /* if we don't queue here, we cannot restart the forward search */
+                                if (nlocal == LOCAL_QUEUE_SIZE) {
+                                    flush_local_queue(queue, &Qnext, local, &nlocal);
+                                }
+                                local[nlocal++] = i;
+                                done = 1;
+                            }
+                        } STINGER_FORALL_IN_EDGES_OF_VTX_END();
+                    }
+                }
+                flush_local_queue(queue, &Qnext, local, &nlocal);
             }
         }
 
+        /* the next frontier is everything queued during this step */
+        Qhead[++nQ] = Qnext;
         Qstart = Qhead[nQ-1];
-        Qend = Qnext;
-        Qhead[nQ++] = Qend;
+        Qend = Qhead[nQ];
 
         /* calculate new transition parameters */
         nf_last = nf;
         nf = Qend - Qstart;
         mf = 0;
-        OMP ("omp parallel for reduction(+:mf) reduction(-:mu)")
+        OMP ("omp parallel for reduction(+:mf)")
         for (int64_t j = Qstart; j < Qend; j++) {
-            int64_t deg_j = stinger_outdegree_get(S, queue[j]);
-            mf += deg_j;
-            mu -= deg_j;
+            mf += stinger_outdegree_get(S, queue[j]);
         }
-        //printf("mf: %ld, nf: %ld, mu: %ld, nf_last: %ld\n", mf, nf, mu, nf_last);
+        mu -= mf;
 
         /* evaluate the transition state machine */
         if (top_down) {
-            if (mf > (mu / 14) && (nf - nf_last > 0)) {
+            /* the frontier is growing and has more edges to check than a fraction of the unexplored vertices */
+            if (mf > (mu / alpha) && (nf - nf_last > 0)) {
                 top_down = 0;
             }
         } else {
-            if (nf < (nv / 24) && (nf - nf_last < 0)) {
+            /* the frontier is shrinking and has become a small fraction of the graph */
+            if (nf < (nv / beta) && (nf - nf_last < 0)) {
                 top_down = 1;
             }
         }
@@ -155,3 +182,92 @@ direction_optimizing_parallel_breadth_first_search (struct stinger * S, int64_t
 
     return nQ;
 }
+
+/* Sets bits in a word shared between threads */
+static inline void
+atomic_or (uint64_t * word, uint64_t bits)
+{
+    uint64_t old = *word;
+    while ((old & bits) != bits) {
+        uint64_t prev = (uint64_t)stinger_int64_cas ((int64_t *)word, (int64_t)old, (int64_t)(old | bits));
+        if (prev == old) break;
+        old = prev;
+    }
+}
+
+int64_t
+multi_source_breadth_first_search (struct stinger * S, int64_t nv,
+                            const int64_t * sources, int64_t num_sources,
+                            uint64_t * seen, uint64_t * frontier, uint64_t * next,
+                            int64_t * level, int64_t * all_levels)
+{
+    if (num_sources < 1 || num_sources > MSBFS_MAX_SOURCES) {
+        LOG_E_A("Multi-source BFS supports 1 to %d sources, got %ld", MSBFS_MAX_SOURCES, (long)num_sources);
+        return 0;
+    }
+
+    /* level[] holds the distances from the last source, as if each source was searched in order */
+    const uint64_t last_bit = 1ULL << (num_sources - 1);
+
+    OMP("omp parallel for")
+    for (int64_t i = 0; i < nv; i++) {
+        level[i] = -1;
+        seen[i] = 0;
+        frontier[i] = 0;
+        next[i] = 0;
+    }
+    if (all_levels) {
+        OMP("omp parallel for")
+        for (int64_t i = 0; i < nv * num_sources; i++) {
+            all_levels[i] = -1;
+        }
+    }
+
+    /* initialize, bit s of each word belongs to the search from sources[s] */
+    for (int64_t s = 0; s < num_sources; s++) {
+        int64_t v = sources[s];
+        seen[v] |= 1ULL << s;
+        frontier[v] |= 1ULL << s;
+        if (all_levels) all_levels[s * nv + v] = 0;
+    }
+    level[sources[num_sources - 1]] = 0;
+
+    int64_t nQ = 1;  /* level we are currently processing */
+    int64_t active = 1;
+    while (active) {
+        /* visit the neighbors of each vertex once, for every search that reached it in the last level */
+        OMP ("omp parallel for schedule(dynamic, 64)")
+        for (int64_t v = 0; v < nv; v++) {
+            const uint64_t bits = frontier[v];
+            if (!bits) continue;
+            STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN (S, v) {
+                const int64_t w = STINGER_EDGE_DEST;
+                /* skip the atomic if every one of these searches has already been here */
+                if (bits & ~seen[w]) {
+                    atomic_or (&next[w], bits);
+                }
+            } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+        }
+
+        /* mark the new frontier as visited, and record the level for each search that reached it */
+        active = 0;
+        OMP ("omp parallel for reduction(|:active)")
+        for (int64_t w = 0; w < nv; w++) {
+            uint64_t bits = next[w] & ~seen[w];
+            next[w] = 0;
+            frontier[w] = bits;
+            if (!bits) continue;
+            seen[w] |= bits;
+            active = 1;
+            if (bits & last_bit) level[w] = nQ;
+            if (all_levels) {
+                for (uint64_t b = bits; b; b &= b - 1) {
+                    all_levels[__builtin_ctzll (b) * nv + w] = nQ;
+                }
+            }
+        }
+        nQ++;
+    }
+
+    return nQ;
+}
@@ -13,6 +13,10 @@ extern "C" {
 }
 #include "dynamic_bfs.h"
 
+#include <algorithm>
+#include <string>
+#include <hooks.h>
+
 using namespace gt::stinger;
 
 void
@@ -22,7 +26,15 @@ BreadthFirstSearch::setSources(const std::vector<int64_t> &sources)
 }
 
 std::string
-BreadthFirstSearch::getName() { return "bfs"; }
+BreadthFirstSearch::getName()
+{
+    switch (mode) {
+        case TOP_DOWN: return "top_down_bfs";
+        case MULTI_SOURCE: return "ms_bfs";
+        case INCREMENTAL: return "bfs_updating";
+        default: return "bfs";
+    }
+}
 
 int64_t
 BreadthFirstSearch::getDataPerVertex() { return sizeof(int64_t); }
@@ -30,43 +42,322 @@ BreadthFirstSearch::getDataPerVertex() { return sizeof(int64_t); }
 std::string
 BreadthFirstSearch::getDataDescription() { return "l level"; }
 
-BreadthFirstSearch::BreadthFirstSearch()
+BreadthFirstSearch::BreadthFirstSearch(Mode mode, double alpha, double beta, double max_affected_fraction)
+: queue(NULL)
+, Qhead(NULL)
+, frontier_bits(NULL)
+, directions(NULL)
+, seen(NULL)
+, frontier(NULL)
+, next(NULL)
+, mode(mode)
+, alpha(alpha)
+, beta(beta)
+, max_affected_fraction(max_affected_fraction)
+, unreached_from(0)
 {
 }
 
+BreadthFirstSearch::~BreadthFirstSearch()
+{
+    xfree(queue);
+    xfree(Qhead);
+    xfree(frontier_bits);
+    xfree(directions);
+    xfree(seen);
+    xfree(frontier);
+    xfree(next);
+}
+
 void
 BreadthFirstSearch::onInit(stinger_registered_alg * alg)
 {
     level = (int64_t*)alg->alg_data;
+
+    int64_t max_nv = alg->stinger->max_nv;
+    // Nothing is known about the levels we were given
+    unreached_from = max_nv;
+    if (mode == MULTI_SOURCE) {
+        seen = (uint64_t *)xmalloc(sizeof(uint64_t) * max_nv);
+        frontier = (uint64_t *)xmalloc(sizeof(uint64_t) * max_nv);
+        next = (uint64_t *)xmalloc(sizeof(uint64_t) * max_nv);
+    } else {
+        queue = (int64_t *)xmalloc(sizeof(int64_t) * max_nv);
+        // One entry per level, plus the end of the last frontier
+        Qhead = (int64_t *)xmalloc(sizeof(int64_t) * (max_nv + 2));
+        if (mode == DIRECTION_OPTIMIZING || mode == INCREMENTAL) {
+            frontier_bits = (uint64_t *)xmalloc(sizeof(uint64_t) * ((max_nv + 63) / 64));
+        }
+        if (mode == DIRECTION_OPTIMIZING) {
+            directions = (char *)xmalloc(sizeof(char) * max_nv);
+        }
+    }
 }
 
 void
 BreadthFirstSearch::onPre(stinger_registered_alg * alg)
 {
-    /* nothing to do */
+    if (mode != INCREMENTAL) { return; }
+    pending.collect(alg);
 }
 
 void
 BreadthFirstSearch::onPost(stinger_registered_alg * alg)
+{
+    if (mode == MULTI_SOURCE) {
+        searchMultiSource(alg);
+    } else if (mode == INCREMENTAL) {
+        searchIncremental(alg);
+    } else {
+        searchEachSource(alg);
+    }
+}
+
+void
+BreadthFirstSearch::searchEachSource(stinger_registered_alg * alg)
 {
     int64_t nv = alg->max_active_vertex + 1;
-    int64_t *marks = (int64_t *)xcalloc(sizeof(int64_t), nv);
-    int64_t *queue = (int64_t *)xcalloc(sizeof(int64_t), nv);
-    int64_t *Qhead = (int64_t *)xcalloc(sizeof(int64_t), nv);
-    int64_t levels;
+
+    // Record the direction of each step, so we can see where the search switched
+    std::string all_directions;
+    int64_t top_down_levels = 0, bottom_up_levels = 0;
 
     for (int64_t source : sources) {
-        levels = parallel_breadth_first_search(
+        if (mode == DIRECTION_OPTIMIZING) {
+            int64_t levels = direction_optimizing_parallel_breadth_first_search(
+                alg->stinger,
+                nv,
+                source,
+                queue,
+                Qhead,
+                level,
+                frontier_bits,
+                alpha,
+                beta,
+                directions
+            );
+            // One step per level, including the last one which finds nothing new
+            std::string source_directions(directions, levels - 1);
+            top_down_levels += std::count(source_directions.begin(), source_directions.end(), 'T');
+            bottom_up_levels += std::count(source_directions.begin(), source_directions.end(), 'B');
+            if (!all_directions.empty()) { all_directions += " "; }
+            all_directions += source_directions;
+        } else {
+            parallel_breadth_first_search(
+                alg->stinger,
+                nv,
+                source,
+                queue,
+                Qhead,
+                level
+            );
+        }
+    }
+
+    if (mode == DIRECTION_OPTIMIZING) {
+        Hooks &hooks = Hooks::getInstance();
+        hooks.set_stat("bfs_directions", all_directions);
+        hooks.set_stat("bfs_top_down_levels", top_down_levels);
+        hooks.set_stat("bfs_bottom_up_levels", bottom_up_levels);
+    }
+}
+
+void
+BreadthFirstSearch::searchMultiSource(stinger_registered_alg * alg)
+{
+    if (sources.empty()) { return; }
+    int64_t nv = alg->max_active_vertex + 1;
+
+    // Process sources in groups of 64, the level array ends up with the distances from the last source
+    for (size_t first = 0; first < sources.size(); first += MSBFS_MAX_SOURCES) {
+        int64_t num_sources = std::min<int64_t>(MSBFS_MAX_SOURCES, sources.size() - first);
+        multi_source_breadth_first_search(
+            alg->stinger,
+            nv,
+            sources.data() + first,
+            num_sources,
+            seen,
+            frontier,
+            next,
+            level,
+            NULL
+        );
+    }
+}
+
+void
+BreadthFirstSearch::searchIncremental(stinger_registered_alg * alg)
+{
+    pending.consume();
+    if (sources.empty()) { return; }
+    int64_t nv = alg->max_active_vertex + 1;
+    int64_t source = sources.back();
+
+    // Vertices that become active later must start out unreached
+    // Only the ones that were active in the last run (or all of them the first time) can have a level
+    OMP("omp parallel for")
+    for (int64_t v = nv; v < unreached_from; v++) {
+        level[v] = -1;
+    }
+    unreached_from = nv;
+
+    int64_t num_affected = 0;
+    bool repaired = pending.complete() && repairLevels(alg, source, num_affected);
+    if (!repaired) {
+        direction_optimizing_parallel_breadth_first_search(
             alg->stinger,
             nv,
             source,
-            marks,
             queue,
             Qhead,
-            level
+            level,
+            frontier_bits,
+            alpha,
+            beta,
+            NULL
         );
     }
-    xfree(marks);
-    xfree(queue);
-    xfree(Qhead);
+
+    Hooks &hooks = Hooks::getInstance();
+    hooks.set_stat("bfs_repaired", static_cast<int64_t>(repaired));
+    hooks.set_stat("bfs_affected_vertices", num_affected);
+}
+
+bool
+BreadthFirstSearch::repairLevels(stinger_registered_alg * alg, int64_t source, int64_t &num_affected)
+{
+    stinger_t * S = alg->stinger;
+    int64_t nv = alg->max_active_vertex + 1;
+    int64_t max_affected = max_affected_fraction * nv;
+
+    // The previous levels must be a search from the same source
+    // (the source changes when another vertex becomes the highest-degree vertex)
+    // Only the active vertices need checking, the rest were just reset
+    if (source < 0 || source >= nv || level[source] != 0) { return false; }
+    int64_t num_roots = 0, num_invalid = 0;
+    OMP("omp parallel for reduction(+:num_roots, num_invalid)")
+    for (int64_t v = 0; v < nv; v++) {
+        if (level[v] == 0) { num_roots += 1; }
+        else if (level[v] < -1 || level[v] >= nv) { num_invalid += 1; }
+    }
+    if (num_roots != 1 || num_invalid != 0) { return false; }
+
+    // Step 1: Remove vertices that lost their last parent, one level at a time
+    // Candidates are vertices that may have lost a parent, indexed by level
+    std::vector<std::vector<int64_t>> candidates;
+    for (const stinger_edge_update &d : pending.deletions) {
+        int64_t u = d.source, v = d.destination;
+        if (level[u] >= 0 && level[v] == level[u] + 1) {
+            if (static_cast<int64_t>(candidates.size()) <= level[v]) { candidates.resize(level[v] + 1); }
+            candidates[level[v]].push_back(v);
+        }
+    }
+    std::vector<int64_t> invalidated;
+    for (int64_t l = 1; l < static_cast<int64_t>(candidates.size()); ++l) {
+        if (candidates[l].empty()) { continue; }
+        // Resize before taking references into candidates
+        if (static_cast<int64_t>(candidates.size()) <= l + 1) { candidates.resize(l + 2); }
+        std::vector<int64_t> &current = candidates[l];
+        std::vector<int64_t> &children = candidates[l + 1];
+        std::sort(current.begin(), current.end());
+        current.erase(std::unique(current.begin(), current.end()), current.end());
+
+        OMP("omp parallel")
+        {
+            std::vector<int64_t> my_invalidated, my_children;
+            OMP("omp for schedule(dynamic, 64) nowait")
+            for (size_t i = 0; i < current.size(); ++i) {
+                int64_t v = current[i];
+                // Levels up to l-1 have all been settled, so any parent left at level l-1 is still valid
+                int64_t has_parent = 0;
+                STINGER_FORALL_IN_EDGES_OF_VTX_BEGIN(S, v) {
+                    if (has_parent) break;
+                    if (level[STINGER_EDGE_DEST] == l - 1) { has_parent = 1; }
+                } STINGER_FORALL_IN_EDGES_OF_VTX_END();
+                if (has_parent) { continue; }
+
+                // Only this thread writes level[v], and no vertex at level l reads it during this step
+                level[v] = -1;
+                my_invalidated.push_back(v);
+                STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, v) {
+                    if (level[STINGER_EDGE_DEST] == l + 1) { my_children.push_back(STINGER_EDGE_DEST); }
+                } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+            }
+            OMP("omp critical")
+            {
+                invalidated.insert(invalidated.end(), my_invalidated.begin(), my_invalidated.end());
+                children.insert(children.end(), my_children.begin(), my_children.end());
+            }
+        }
+        if (static_cast<int64_t>(invalidated.size()) > max_affected) { return false; }
+    }
+
+    // Step 2: Find the best remaining parent for each invalidated vertex and each destination of an inserted edge
+    std::vector<int64_t> dirty = invalidated;
+    for (const stinger_edge_update &e : pending.insertions) { dirty.push_back(e.destination); }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<int64_t> best(dirty.size());
+    OMP("omp parallel for schedule(dynamic, 64)")
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        int64_t v = dirty[i];
+        int64_t b = -1;
+        STINGER_FORALL_IN_EDGES_OF_VTX_BEGIN(S, v) {
+            int64_t l = level[STINGER_EDGE_DEST];
+            if (l >= 0 && (b < 0 || l + 1 < b)) { b = l + 1; }
+        } STINGER_FORALL_IN_EDGES_OF_VTX_END();
+        best[i] = b;
+    }
+
+    // Lower each dirty vertex to its best level, and sort them by level
+    std::vector<std::pair<int64_t, int64_t>> seeds;
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        int64_t v = dirty[i];
+        if (best[i] > 0 && (level[v] < 0 || best[i] < level[v])) {
+            level[v] = best[i];
+            seeds.push_back(std::make_pair(best[i], v));
+        }
+    }
+    std::sort(seeds.begin(), seeds.end());
+    num_affected = invalidated.size();
+
+    // Step 3: Push the new levels outward, one level at a time, like a BFS that starts from many levels at once
+    std::vector<int64_t> current, next_level;
+    size_t next_seed = 0;
+    int64_t l = 0;
+    while (!current.empty() || next_seed < seeds.size()) {
+        if (current.empty()) { l = seeds[next_seed].first; }
+        // Add the seeds for this level, unless they were lowered again since
+        for (; next_seed < seeds.size() && seeds[next_seed].first == l; ++next_seed) {
+            int64_t v = seeds[next_seed].second;
+            if (level[v] == l) { current.push_back(v); }
+        }
+        num_affected += current.size();
+        if (num_affected > max_affected) { return false; }
+
+        next_level.clear();
+        OMP("omp parallel")
+        {
+            std::vector<int64_t> mine;
+            OMP("omp for schedule(dynamic, 64) nowait")
+            for (size_t i = 0; i < current.size(); ++i) {
+                STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, current[i]) {
+                    const int64_t x = STINGER_EDGE_DEST;
+                    // Whoever lowers the level first gets to queue the vertex
+                    int64_t old = level[x];
+                    while (old < 0 || old > l + 1) {
+                        int64_t prev = stinger_int64_cas(&level[x], old, l + 1);
+                        if (prev == old) { mine.push_back(x); break; }
+                        old = prev;
+                    }
+                } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+            }
+            OMP("omp critical")
+            next_level.insert(next_level.end(), mine.begin(), mine.end());
+        }
+        current.swap(next_level);
+        l += 1;
+    }
+    return true;
 }
@@ -0,0 +1,38 @@
+#ifndef STINGER_LOCAL_QUEUE_H_
+#define STINGER_LOCAL_QUEUE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "stinger_core/stinger_atomics.h"
+
+/* Helpers for the parallel traversals, which buffer the vertices each thread finds before adding them to a shared list */
+
+/* Number of vertices each thread collects before appending them to a shared list */
+#define LOCAL_QUEUE_SIZE 256
+
+/* Appends a thread's buffered vertices to a shared list, reserving space with a single fetch-add */
+static inline void
+flush_local_queue (int64_t * list, int64_t * list_size, const int64_t * local, int64_t * nlocal)
+{
+  if (*nlocal == 0) return;
+  int64_t start = stinger_int64_fetch_add(list_size, *nlocal);
+  memcpy(&list[start], local, *nlocal * sizeof(int64_t));
+  *nlocal = 0;
+}
+
+/* Adds to a double shared between threads, returning the new value */
+static inline double
+atomic_add_double (double * x, double value)
+{
+  union { double d; int64_t i; } old_value, new_value;
+  old_value.d = *x;
+  while (1) {
+    new_value.d = old_value.d + value;
+    int64_t prev = stinger_int64_cas((int64_t *)x, old_value.i, new_value.i);
+    if (prev == old_value.i) break;
+    old_value.i = prev;
+  }
+  return new_value.d;
+}
+
+#endif
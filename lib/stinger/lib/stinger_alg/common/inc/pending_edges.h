@@ -0,0 +1,68 @@
+#ifndef STINGER_PENDING_EDGES_H_
+#define STINGER_PENDING_EDGES_H_
+
+#include <stdint.h>
+#include <vector>
+#include "stinger_core/stinger.h"
+#include "stinger_net/stinger_alg.h"
+namespace gt {
+  namespace stinger {
+    // Collects the edges inserted and deleted between runs of an incremental algorithm
+    // Call collect() from onPre, and consume() from onPost once the changes have been used
+    class PendingEdges
+    {
+    public:
+        std::vector<stinger_edge_update> insertions;
+        std::vector<stinger_edge_update> deletions;
+
+        PendingEdges() : tracking(false), overflow(false), consumed(false) {}
+
+        // Adds the edges from this batch. Several batches may be inserted between runs, keeps the changes from all of them
+        // Returns true if this started a new list, because the previous one was consumed
+        bool collect(stinger_registered_alg * alg)
+        {
+            bool started = consumed;
+            if (consumed) {
+                insertions.clear();
+                deletions.clear();
+                overflow = false;
+                consumed = false;
+            }
+            tracking = true;
+            if (overflow) { return started; }
+
+            // Once more edges have changed than there are vertices, starting over will be cheaper than using them
+            int64_t num_pending = insertions.size() + deletions.size() + alg->num_insertions + alg->num_deletions;
+            if (num_pending > static_cast<int64_t>(alg->stinger->max_nv)) {
+                overflow = true;
+                insertions.clear();
+                deletions.clear();
+                return started;
+            }
+            insertions.insert(insertions.end(), alg->insertions, alg->insertions + alg->num_insertions);
+            deletions.insert(deletions.end(), alg->deletions, alg->deletions + alg->num_deletions);
+            return started;
+        }
+
+        // Marks the list as used, so the next collect() starts a new one (each alg trial in an epoch sees the same changes)
+        // Returns false if it was already used, meaning the graph hasn't changed since
+        bool consume()
+        {
+            bool changed = !consumed;
+            consumed = true;
+            return changed;
+        }
+
+        // True if the list holds every change since the last run:
+        // collect() has been called since the graph was loaded, and not too many edges changed
+        bool complete() const { return tracking && !overflow; }
+
+    private:
+        bool tracking;
+        bool overflow;
+        bool consumed;
+    };
+  }
+}
+
+#endif
@@ -20,6 +20,8 @@ namespace gt {
 
         double * pr;
         double * tmp_pr;
+        // 1/outdegree of each vertex, refreshed at the start of each run
+        double * inv_outdegree;
     public:
         PageRank(
           const char * type_str,
@@ -0,0 +1,55 @@
+#ifndef STINGER_DYNAMIC_PAGERANK_PUSH_H_
+#define STINGER_DYNAMIC_PAGERANK_PUSH_H_
+
+#include <stdint.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <vector>
+#include "stinger_net/stinger_alg.h"
+#include "streaming_algorithm.h"
+#include "pending_edges.h"
+extern "C" {
+#include "stinger_alg/pagerank.h"
+}
+namespace gt {
+  namespace stinger {
+    // PageRank that starts from the ranks of the previous epoch, and only pushes residuals out from the edges that changed
+    class PageRankPush : public IDynamicGraphAlgorithm
+    {
+    private:
+        double epsilon;
+        double dampingfactor;
+        int64_t maxiter;
+
+        double * pr;
+        // Workspace for full searches
+        double * tmp_pr;
+        double * inv_outdegree;
+        page_rank_push_workspace_t * workspace;
+
+        // Edges changed since the last onPost
+        PendingEdges pending;
+        // Constant share and number of vertices from the last run, and from the last run of the previous epoch,
+        // which is what the ranks passed in to this epoch were computed with
+        bool has_last_run;
+        double last_constant;
+        int64_t last_nv;
+        bool has_previous_run;
+        double previous_constant;
+        int64_t previous_nv;
+    public:
+        PageRankPush(double epsilon, double dampingfactor, int64_t maxiter);
+        ~PageRankPush();
+
+        // Overridden from IDynamicGraphAlgorithm
+        std::string getName();
+        int64_t getDataPerVertex();
+        std::string getDataDescription();
+        void onInit(stinger_registered_alg * alg);
+        void onPre(stinger_registered_alg * alg);
+        void onPost(stinger_registered_alg * alg);
+    };
+  }
+}
+
+#endif
@@ -12,6 +12,27 @@
 int64_t page_rank_subset(stinger_t * S, int64_t NV, uint8_t * vertex_set, int64_t vertex_set_size, double * pr, double * tmp_pr_in, double epsilon, double dampingfactor, int64_t maxiter);
 int64_t page_rank_directed(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double epsilon, double dampingfactor, int64_t maxiter);
 int64_t page_rank (stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double epsilon, double dampingfactor, int64_t maxiter);
+/*
+ * Same as page_rank, but caches 1/outdegree of each vertex in inv_outdegree (NV entries, or NULL to allocate it)
+ * and computes each iteration in a single pass, swapping pr and tmp_pr between iterations.
+ * Returns the number of iterations.
+ */
+int64_t page_rank_pull(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double * inv_outdegree_in, double epsilon, double dampingfactor, int64_t maxiter);
+/*
+ * Residual-push PageRank, for updating ranks that were computed before the graph changed.
+ * Only the residuals of the seeds and their out-neighbors are recomputed; pass the endpoints of the changed edges
+ * (and any vertices that became active) as seeds. Stops once every residual is below epsilon/NV,
+ * so the residuals left over add up to at most epsilon, like the convergence test in page_rank_pull.
+ * constant is the share of rank each vertex gets from teleporting and from vertices without out-edges.
+ * On input it is the value pr was computed with (<= 0 if pr was just computed on this graph), on output the new value.
+ * Returns the number of pushes, and sets num_touched to the number of vertices whose residual was computed.
+ */
+typedef struct page_rank_push_workspace page_rank_push_workspace_t;
+page_rank_push_workspace_t * page_rank_push_workspace_new(int64_t max_nv);
+void page_rank_push_workspace_free(page_rank_push_workspace_t * ws);
+int64_t page_rank_push(page_rank_push_workspace_t * ws, stinger_t * S, int64_t NV, double * pr,
+                       const int64_t * seeds, int64_t num_seeds, double * constant,
+                       double epsilon, double dampingfactor, int64_t * num_touched);
 int64_t page_rank_type(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double epsilon, double dampingfactor, int64_t maxiter, int64_t type);
 int64_t page_rank_type_directed(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double epsilon, double dampingfactor, int64_t maxiter, int64_t type);
 
@@ -49,6 +49,7 @@ PageRank::onInit(stinger_registered_alg * alg)
     }
 
     tmp_pr = (double *)xcalloc(alg->stinger->max_nv, sizeof(double));
+    inv_outdegree = (double *)xcalloc(alg->stinger->max_nv, sizeof(double));
 
     int64_t nv = alg->max_active_vertex + 1;
     int64_t type = -1;
@@ -58,7 +59,7 @@ PageRank::onInit(stinger_registered_alg * alg)
     if(type_specified && type > -1) {
       page_rank_type(alg->stinger, nv, pr, tmp_pr, epsilon, dampingfactor, maxiter, type);
     } else if (!type_specified) {
-      page_rank(alg->stinger, nv, pr, tmp_pr, epsilon, dampingfactor, maxiter);
+      page_rank_pull(alg->stinger, nv, pr, tmp_pr, inv_outdegree, epsilon, dampingfactor, maxiter);
     }
 }
 
@@ -86,11 +87,12 @@ PageRank::onPost(stinger_registered_alg * alg)
         }
       }
     } else {
-      page_rank(alg->stinger, nv, pr, tmp_pr, epsilon, dampingfactor, maxiter);
+      page_rank_pull(alg->stinger, nv, pr, tmp_pr, inv_outdegree, epsilon, dampingfactor, maxiter);
     }
 }
 
 PageRank::~PageRank()
 {
     xfree(tmp_pr);
+    xfree(inv_outdegree);
 }
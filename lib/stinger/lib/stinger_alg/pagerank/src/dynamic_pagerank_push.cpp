@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <stdbool.h>
+
+#include "stinger_core/stinger.h"
+#include "stinger_core/stinger_atomics.h"
+#include "stinger_core/xmalloc.h"
+#include "stinger_core/stinger_error.h"
+#include "stinger_net/stinger_alg.h"
+extern "C" {
+#include "stinger_alg/pagerank.h"
+}
+#include "dynamic_pagerank_push.h"
+
+#include <hooks.h>
+
+using namespace gt::stinger;
+
+std::string
+PageRankPush::getName() { return "pagerank_push"; }
+
+int64_t
+PageRankPush::getDataPerVertex() { return sizeof(double); }
+
+std::string
+PageRankPush::getDataDescription() { return "d pagerank"; }
+
+PageRankPush::PageRankPush(double epsilon, double dampingfactor, int64_t maxiter)
+: epsilon(epsilon)
+, dampingfactor(dampingfactor)
+, maxiter(maxiter)
+, pr(NULL)
+, tmp_pr(NULL)
+, inv_outdegree(NULL)
+, workspace(NULL)
+, has_last_run(false)
+, last_constant(0)
+, last_nv(0)
+, has_previous_run(false)
+, previous_constant(0)
+, previous_nv(0)
+{
+}
+
+void
+PageRankPush::onInit(stinger_registered_alg * alg)
+{
+    int64_t max_nv = alg->stinger->max_nv;
+    pr = (double *)alg->alg_data;
+    OMP("omp parallel for")
+    for(int64_t v = 0; v < max_nv; v++) {
+      pr[v] = 1 / ((double)max_nv);
+    }
+
+    tmp_pr = (double *)xcalloc(max_nv, sizeof(double));
+    inv_outdegree = (double *)xcalloc(max_nv, sizeof(double));
+    workspace = page_rank_push_workspace_new(max_nv);
+
+    int64_t nv = alg->max_active_vertex + 1;
+    page_rank_pull(alg->stinger, nv, pr, tmp_pr, inv_outdegree, epsilon, dampingfactor, maxiter);
+}
+
+void
+PageRankPush::onPre(stinger_registered_alg * alg)
+{
+    if (pending.collect(alg)) {
+        // The next epoch starts from the ranks of this one
+        has_previous_run = has_last_run;
+        previous_constant = last_constant;
+        previous_nv = last_nv;
+    }
+}
+
+void
+PageRankPush::onPost(stinger_registered_alg * alg)
+{
+    pending.consume();
+    int64_t nv = alg->max_active_vertex + 1;
+
+    bool warm_start = pending.complete() && has_previous_run && previous_nv <= nv;
+    double constant = -1;
+    int64_t pushes = 0, touched = 0;
+    if (warm_start) {
+        // Residuals can only have changed at the endpoints of the changed edges, and at vertices that became active
+        std::vector<int64_t> seeds;
+        for (const stinger_edge_update &e : pending.insertions) {
+            seeds.push_back(e.source);
+            seeds.push_back(e.destination);
+        }
+        for (const stinger_edge_update &e : pending.deletions) {
+            seeds.push_back(e.source);
+            seeds.push_back(e.destination);
+        }
+        for (int64_t v = previous_nv; v < nv; v++) { seeds.push_back(v); }
+
+        constant = previous_constant;
+        pushes = page_rank_push(workspace, alg->stinger, nv, pr, seeds.data(), seeds.size(), &constant,
+            epsilon, dampingfactor, &touched);
+    } else {
+        page_rank_pull(alg->stinger, nv, pr, tmp_pr, inv_outdegree, epsilon, dampingfactor, maxiter);
+        // Nothing to push, this just finds the constant share the ranks were computed with
+        page_rank_push(workspace, alg->stinger, nv, pr, NULL, 0, &constant, epsilon, dampingfactor, NULL);
+    }
+    has_last_run = true;
+    last_constant = constant;
+    last_nv = nv;
+
+    Hooks &hooks = Hooks::getInstance();
+    hooks.set_stat("pagerank_warm_started", static_cast<int64_t>(warm_start));
+    hooks.set_stat("pagerank_pushes", pushes);
+    hooks.set_stat("pagerank_touched_vertices", touched);
+}
+
+PageRankPush::~PageRankPush()
+{
+    xfree(tmp_pr);
+    xfree(inv_outdegree);
+    page_rank_push_workspace_free(workspace);
+}
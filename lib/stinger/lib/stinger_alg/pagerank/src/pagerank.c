@@ -2,6 +2,10 @@
 
 #include "pagerank.h"
 #include "stinger_core/x86_full_empty.h"
+#include "stinger_core/stinger_atomics.h"
+#include "local_queue.h"
+#include <hooks_c.h>
+#include <string.h>
 
 inline double * set_tmp_pr(double * tmp_pr_in, int64_t NV) {
   double * tmp_pr = NULL;
@@ -119,6 +123,7 @@ page_rank (stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double ep
 
     double pr_constant = 0.0;
 
+    DYNOGRAPH_SUBREGION_BEGIN("gather");
     OMP("omp parallel for reduction(+:pr_constant)")
     for (uint64_t v = 0; v < NV; v++) {
       tmp_pr[v] = 0;
@@ -133,12 +138,16 @@ page_rank (stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double ep
         } STINGER_FORALL_IN_EDGES_OF_VTX_END();
       }
     }
+    DYNOGRAPH_SUBREGION_END();
 
+    DYNOGRAPH_SUBREGION_BEGIN("normalize");
     OMP("omp parallel for")
     for (uint64_t v = 0; v < NV; v++) {
       tmp_pr[v] = (tmp_pr[v] + pr_constant / (double)NV) * dampingfactor + (((double)(1-dampingfactor)) / ((double)NV));
     }
+    DYNOGRAPH_SUBREGION_END();
 
+    DYNOGRAPH_SUBREGION_BEGIN("convergence");
     delta = 0;
     OMP("omp parallel for reduction(+:delta)")
     for (uint64_t v = 0; v < NV; v++) {
@@ -153,6 +162,7 @@ page_rank (stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double ep
     for (uint64_t v = 0; v < NV; v++) {
       pr[v] = tmp_pr[v];
     }
+    DYNOGRAPH_SUBREGION_END();
 
     iter--;
   }
@@ -162,6 +172,321 @@ page_rank (stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double ep
   unset_tmp_pr(tmp_pr,tmp_pr_in);
 }
 
+int64_t
+page_rank_pull (stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double * inv_outdegree_in, double epsilon, double dampingfactor, int64_t maxiter)
+{
+  double * tmp_pr = set_tmp_pr(tmp_pr_in, NV);
+  double * inv_outdegree = set_tmp_pr(inv_outdegree_in, NV);
+
+  /* Look up each out-degree once, instead of for every edge on every iteration */
+  double pr_constant = 0.0;
+  DYNOGRAPH_SUBREGION_BEGIN("outdegree");
+  OMP("omp parallel for reduction(+:pr_constant)")
+  for (int64_t v = 0; v < NV; v++) {
+    int64_t outdegree = stinger_outdegree_get(S, v);
+    inv_outdegree[v] = outdegree ? 1.0 / (double)outdegree : 0.0;
+    if (outdegree == 0) {
+      pr_constant += pr[v];
+    }
+  }
+  DYNOGRAPH_SUBREGION_END();
+
+  /* Ranks are read from src and written to dst, then the buffers trade places */
+  double * src = pr;
+  double * dst = tmp_pr;
+  const double teleport = ((double)(1-dampingfactor)) / ((double)NV);
+
+  int64_t iter_count = 0;
+  double delta = 1;
+
+  while (delta > epsilon && iter_count < maxiter) {
+    iter_count++;
+
+    const double dangling_share = pr_constant / (double)NV;
+    double next_pr_constant = 0.0;
+    delta = 0;
+
+    /* Gather, normalize and measure convergence in one pass, summing the dangling ranks for the next iteration */
+    DYNOGRAPH_SUBREGION_BEGIN("gather");
+    OMP("omp parallel for reduction(+:delta, next_pr_constant) schedule(dynamic, 64)")
+    for (int64_t v = 0; v < NV; v++) {
+      double sum = 0;
+      /* Like page_rank, vertices with no out-edges only receive the teleport and dangling shares */
+      if (inv_outdegree[v] != 0) {
+        STINGER_FORALL_IN_EDGES_OF_VTX_BEGIN(S, v) {
+          sum += src[STINGER_EDGE_DEST] * inv_outdegree[STINGER_EDGE_DEST];
+        } STINGER_FORALL_IN_EDGES_OF_VTX_END();
+      }
+      const double rank = (sum + dangling_share) * dampingfactor + teleport;
+      dst[v] = rank;
+
+      double mydelta = rank - src[v];
+      if (mydelta < 0)
+        mydelta = -mydelta;
+      delta += mydelta;
+
+      if (inv_outdegree[v] == 0) {
+        next_pr_constant += rank;
+      }
+    }
+    DYNOGRAPH_SUBREGION_END();
+
+    double * t = src; src = dst; dst = t;
+    pr_constant = next_pr_constant;
+  }
+
+  /* After an odd number of iterations the latest ranks are in the other buffer */
+  if (src != pr) {
+    OMP("omp parallel for simd")
+    for (int64_t v = 0; v < NV; v++) {
+      pr[v] = src[v];
+    }
+  }
+
+  LOG_I_A("PageRank iteration count : %ld", iter_count);
+
+  unset_tmp_pr(inv_outdegree, inv_outdegree_in);
+  unset_tmp_pr(tmp_pr, tmp_pr_in);
+  return iter_count;
+}
+
+struct page_rank_push_workspace {
+  int64_t max_nv;
+  double * residual;       /* zero outside page_rank_push */
+  double * inv_outdegree;  /* 1/outdegree, zero for vertices with no out-edges */
+  int64_t * mark;          /* 0 = untouched, 1 = touched, 2 = queued; zero outside page_rank_push */
+  int64_t * frontier;
+  int64_t * next_frontier;
+  int64_t * touched;
+};
+
+page_rank_push_workspace_t *
+page_rank_push_workspace_new (int64_t max_nv)
+{
+  page_rank_push_workspace_t * ws = (page_rank_push_workspace_t *)xmalloc(sizeof(page_rank_push_workspace_t));
+  ws->max_nv = max_nv;
+  ws->residual = (double *)xcalloc(max_nv, sizeof(double));
+  ws->inv_outdegree = (double *)xcalloc(max_nv, sizeof(double));
+  ws->mark = (int64_t *)xcalloc(max_nv, sizeof(int64_t));
+  ws->frontier = (int64_t *)xmalloc(max_nv * sizeof(int64_t));
+  ws->next_frontier = (int64_t *)xmalloc(max_nv * sizeof(int64_t));
+  ws->touched = (int64_t *)xmalloc(max_nv * sizeof(int64_t));
+  return ws;
+}
+
+void
+page_rank_push_workspace_free (page_rank_push_workspace_t * ws)
+{
+  if (ws == NULL) return;
+  xfree(ws->residual);
+  xfree(ws->inv_outdegree);
+  xfree(ws->mark);
+  xfree(ws->frontier);
+  xfree(ws->next_frontier);
+  xfree(ws->touched);
+  xfree(ws);
+}
+
+/* Sets a double shared between threads to zero, returning the old value */
+static inline double
+atomic_take_double (double * x)
+{
+  union { double d; int64_t i; } old_value;
+  old_value.d = *x;
+  while (1) {
+    int64_t prev = stinger_int64_cas((int64_t *)x, old_value.i, 0);
+    if (prev == old_value.i) break;
+    old_value.i = prev;
+  }
+  return old_value.d;
+}
+
+#define PR_APPEND(LIST, SIZE, LOCAL, NLOCAL, V) do { \
+  if ((NLOCAL) == LOCAL_QUEUE_SIZE) flush_local_queue((LIST), (SIZE), (LOCAL), &(NLOCAL)); \
+  (LOCAL)[(NLOCAL)++] = (V); \
+} while (0)
+
+int64_t
+page_rank_push (page_rank_push_workspace_t * ws, stinger_t * S, int64_t NV, double * pr,
+                const int64_t * seeds, int64_t num_seeds, double * constant,
+                double epsilon, double dampingfactor, int64_t * num_touched)
+{
+  if (NV > ws->max_nv) {
+    LOG_E_A("PageRank workspace was created for %ld vertices, but the graph has %ld", (long)ws->max_nv, (long)NV);
+    return 0;
+  }
+  double * residual = ws->residual;
+  double * inv_outdegree = ws->inv_outdegree;
+  int64_t * mark = ws->mark;
+  int64_t * frontier = ws->frontier;
+  int64_t * next_frontier = ws->next_frontier;
+  int64_t * touched = ws->touched;
+  /*
+   * Vertices are only pushed from once their residual reaches epsilon/NV. The residuals left over then add up to
+   * at most epsilon, matching page_rank_pull, which stops once the ranks change by less than epsilon in total.
+   */
+  const double threshold = epsilon / (double)NV;
+
+  /* Cache the out-degrees, and the constant share each vertex gets from teleporting and the dangling vertices */
+  double pr_constant = 0.0;
+  OMP("omp parallel for reduction(+:pr_constant)")
+  for (int64_t v = 0; v < NV; v++) {
+    int64_t outdegree = stinger_outdegree_get(S, v);
+    inv_outdegree[v] = outdegree ? 1.0 / (double)outdegree : 0.0;
+    if (outdegree == 0) {
+      pr_constant += pr[v];
+    }
+  }
+  double current_constant = pr_constant / (double)NV * dampingfactor + ((double)(1-dampingfactor)) / ((double)NV);
+  /*
+   * Residuals are measured against the constant the ranks were computed with.
+   * The change since then applies to every vertex, so it is kept in global_residual until it is large enough to spread.
+   */
+  const double previous_constant = *constant > 0 ? *constant : current_constant;
+  double global_residual = current_constant - previous_constant;
+
+  /* Recompute the residuals at the seeds and their out-neighbors, whose share of each seed may have changed */
+  int64_t ntouched = 0;
+  OMP("omp parallel")
+  {
+    int64_t local[LOCAL_QUEUE_SIZE];
+    int64_t nlocal = 0;
+    OMP("omp for schedule(dynamic, 64) nowait")
+    for (int64_t i = 0; i < num_seeds; i++) {
+      const int64_t s = seeds[i];
+      if (s < 0 || s >= NV) continue;
+      if (mark[s] == 0 && stinger_int64_cas(&mark[s], 0, 1) == 0) {
+        PR_APPEND(touched, &ntouched, local, nlocal, s);
+      }
+      STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, s) {
+        const int64_t w = STINGER_EDGE_DEST;
+        if (mark[w] == 0 && stinger_int64_cas(&mark[w], 0, 1) == 0) {
+          PR_APPEND(touched, &ntouched, local, nlocal, w);
+        }
+      } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+    }
+    flush_local_queue(touched, &ntouched, local, &nlocal);
+  }
+
+  int64_t nfrontier = 0;
+  OMP("omp parallel")
+  {
+    int64_t local[LOCAL_QUEUE_SIZE];
+    int64_t nlocal = 0;
+    OMP("omp for schedule(dynamic, 64) nowait")
+    for (int64_t i = 0; i < ntouched; i++) {
+      const int64_t v = touched[i];
+      double sum = 0;
+      /* Like page_rank, vertices with no out-edges only receive the constant share */
+      if (inv_outdegree[v] != 0) {
+        STINGER_FORALL_IN_EDGES_OF_VTX_BEGIN(S, v) {
+          sum += pr[STINGER_EDGE_DEST] * inv_outdegree[STINGER_EDGE_DEST];
+        } STINGER_FORALL_IN_EDGES_OF_VTX_END();
+      }
+      const double r = sum * dampingfactor + previous_constant - pr[v];
+      residual[v] = r;
+      if (r > threshold || r < -threshold) {
+        mark[v] = 2;
+        PR_APPEND(frontier, &nfrontier, local, nlocal, v);
+      }
+    }
+    flush_local_queue(frontier, &nfrontier, local, &nlocal);
+  }
+
+  int64_t pushes = 0;
+  while (1) {
+    /* Move each residual in the frontier into the rank, and pass a share on to the out-neighbors */
+    while (nfrontier > 0) {
+      int64_t nnext = 0;
+      double dangling = 0.0;
+      OMP("omp parallel")
+      {
+        int64_t local_next[LOCAL_QUEUE_SIZE];
+        int64_t local_touched[LOCAL_QUEUE_SIZE];
+        int64_t nlocal_next = 0, nlocal_touched = 0;
+
+        OMP("omp for schedule(dynamic, 64) reduction(+:pushes, dangling) nowait")
+        for (int64_t i = 0; i < nfrontier; i++) {
+          const int64_t v = frontier[i];
+          /* Unqueue before taking the residual, so anything added later queues it again */
+          mark[v] = 1;
+          const double r = atomic_take_double(&residual[v]);
+          pr[v] += r;
+          pushes++;
+          if (inv_outdegree[v] == 0) {
+            /* A dangling vertex shares its rank with every vertex */
+            dangling += r;
+          } else {
+            const double share = r * dampingfactor * inv_outdegree[v];
+            STINGER_FORALL_OUT_EDGES_OF_VTX_BEGIN(S, v) {
+              const int64_t w = STINGER_EDGE_DEST;
+              /* Vertices with no out-edges don't gather from their in-edges */
+              if (inv_outdegree[w] != 0) {
+                const double rw = atomic_add_double(&residual[w], share);
+                if (mark[w] == 0 && stinger_int64_cas(&mark[w], 0, 1) == 0) {
+                  PR_APPEND(touched, &ntouched, local_touched, nlocal_touched, w);
+                }
+                if ((rw > threshold || rw < -threshold) && mark[w] == 1 && stinger_int64_cas(&mark[w], 1, 2) == 1) {
+                  PR_APPEND(next_frontier, &nnext, local_next, nlocal_next, w);
+                }
+              }
+            } STINGER_FORALL_OUT_EDGES_OF_VTX_END();
+          }
+        }
+        flush_local_queue(next_frontier, &nnext, local_next, &nlocal_next);
+        flush_local_queue(touched, &ntouched, local_touched, &nlocal_touched);
+      }
+      const double dangling_share = dangling / (double)NV * dampingfactor;
+      current_constant += dangling_share;
+      global_residual += dangling_share;
+
+      int64_t * t = frontier; frontier = next_frontier; next_frontier = t;
+      nfrontier = nnext;
+    }
+
+    /* Stop once the residual shared by every vertex is too small to push */
+    if (global_residual <= threshold && global_residual >= -threshold) break;
+
+    OMP("omp parallel")
+    {
+      int64_t local_next[LOCAL_QUEUE_SIZE];
+      int64_t local_touched[LOCAL_QUEUE_SIZE];
+      int64_t nlocal_next = 0, nlocal_touched = 0;
+
+      OMP("omp for nowait")
+      for (int64_t v = 0; v < NV; v++) {
+        const double r = residual[v] + global_residual;
+        residual[v] = r;
+        if (mark[v] == 0) {
+          mark[v] = 1;
+          PR_APPEND(touched, &ntouched, local_touched, nlocal_touched, v);
+        }
+        if (r > threshold || r < -threshold) {
+          mark[v] = 2;
+          PR_APPEND(frontier, &nfrontier, local_next, nlocal_next, v);
+        }
+      }
+      flush_local_queue(frontier, &nfrontier, local_next, &nlocal_next);
+      flush_local_queue(touched, &ntouched, local_touched, &nlocal_touched);
+    }
+    global_residual = 0;
+  }
+
+  /* Drop the residuals that were too small to push, so the workspace is clean for next time */
+  OMP("omp parallel for")
+  for (int64_t i = 0; i < ntouched; i++) {
+    const int64_t v = touched[i];
+    residual[v] = 0;
+    mark[v] = 0;
+  }
+
+  ws->frontier = frontier;
+  ws->next_frontier = next_frontier;
+  *constant = current_constant - global_residual;
+  if (num_touched) *num_touched = ntouched;
+  return pushes;
+}
+
 int64_t
 page_rank_type_directed(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, double epsilon, double dampingfactor, int64_t maxiter, int64_t type)
 {
@@ -179,6 +504,7 @@ page_rank_type(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, doubl
   while (delta > epsilon && iter > 0) {
     double pr_constant = 0.0;
 
+    DYNOGRAPH_SUBREGION_BEGIN("gather");
     OMP("omp parallel for reduction(+:pr_constant)")
     for (uint64_t v = 0; v < NV; v++) {
       tmp_pr[v] = 0;
@@ -194,12 +520,16 @@ page_rank_type(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, doubl
         } STINGER_FORALL_IN_EDGES_OF_TYPE_OF_VTX_END();
       }
     }
+    DYNOGRAPH_SUBREGION_END();
 
+    DYNOGRAPH_SUBREGION_BEGIN("normalize");
     OMP("omp parallel for")
     for (uint64_t v = 0; v < NV; v++) {
       tmp_pr[v] = (tmp_pr[v] + pr_constant / (double)NV) * dampingfactor + (((double)(1-dampingfactor)) / ((double)NV));
     }
+    DYNOGRAPH_SUBREGION_END();
 
+    DYNOGRAPH_SUBREGION_BEGIN("convergence");
     delta = 0;
     OMP("omp parallel for reduction(+:delta)")
     for (uint64_t v = 0; v < NV; v++) {
@@ -213,6 +543,7 @@ page_rank_type(stinger_t * S, int64_t NV, double * pr, double * tmp_pr_in, doubl
     for(uint64_t v = 0; v < NV; v++) {
       pr[v] = tmp_pr[v];
     }
+    DYNOGRAPH_SUBREGION_END();
 
     iter--;
   }
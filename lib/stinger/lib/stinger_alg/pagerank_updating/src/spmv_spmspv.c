@@ -41,10 +41,18 @@
 #define MM_PAUSE() do { } while (0)
 #endif
 
-#if !defined(ATOMIC_FP_FE_EMUL) && !defined(ATOMIC_FP_OPTIMISTIC) && !defined(ATOMIC_FP_OMP)
+/*
+ * How to accumulate into y when several edges share a destination.
+ * ATOMIC_FP_NONE avoids floating-point atomics altogether: the dense
+ * unit products gather along each vertex's edges instead of scattering,
+ * and the other products collect contributions in per-thread buckets
+ * that are summed by the thread owning each range of y.
+ */
+#if !defined(ATOMIC_FP_FE_EMUL) && !defined(ATOMIC_FP_OPTIMISTIC) && !defined(ATOMIC_FP_OMP) && !defined(ATOMIC_FP_NONE)
 /* #define ATOMIC_FP_OMP */
 /* #define ATOMIC_FP_FE_EMUL */
-#define ATOMIC_FP_OPTIMISTIC
+/* #define ATOMIC_FP_OPTIMISTIC */
+#define ATOMIC_FP_NONE
 #endif
 
 // HACK enable alternate OMP macro
@@ -103,14 +111,138 @@ static inline void setup_y (const int64_t nv, const double beta, double * y)
 #define ALPHAXI_VAL(alpha, xi) (alpha == 0.0? 0.0 : (alpha == 1.0? xi : (alpha == -1.0? -xi : (alpha * xi))))
 #define DEGSCALE(axi, degi) (degi == 0? 0.0 : axi / degi);
 
+#if defined(ATOMIC_FP_NONE)
+struct accum_bucket {
+     int64_t n, cap;
+     int64_t * idx;
+     double * val;
+};
+
+/* Bucket [s * accum_nt + t] holds thread s's updates to thread t's part of y.
+   The buckets are kept between calls so they don't have to grow again every iteration. */
+static struct accum_bucket * accum_buckets = NULL;
+static int64_t accum_nt = 0;
+static int64_t accum_part_size;
+
+static struct accum_bucket *
+accum_begin (const int64_t nv)
+{
+     OMP(single) {
+          const int64_t nt = omp_get_num_threads ();
+          if (nt != accum_nt) {
+               for (int64_t k = 0; k < accum_nt * accum_nt; ++k) {
+                    free (accum_buckets[k].idx);
+                    free (accum_buckets[k].val);
+               }
+               free (accum_buckets);
+               accum_buckets = xcalloc (nt * nt, sizeof (*accum_buckets));
+               accum_nt = nt;
+          }
+          accum_part_size = nv > nt? (nv + nt - 1) / nt : 1;
+     }
+     struct accum_bucket * mine = &accum_buckets[omp_get_thread_num () * accum_nt];
+     for (int64_t t = 0; t < accum_nt; ++t) mine[t].n = 0;
+     return mine;
+}
+
+static inline void
+accum_add (struct accum_bucket * mine, double * y, const int64_t j, const double val)
+{
+     struct accum_bucket * b = &mine[j / accum_part_size];
+     if (b->n == b->cap) {
+          b->cap = b->cap? 2 * b->cap : 256;
+          b->idx = xrealloc (b->idx, b->cap * sizeof (*b->idx));
+          b->val = xrealloc (b->val, b->cap * sizeof (*b->val));
+     }
+     b->idx[b->n] = j;
+     b->val[b->n] = val;
+     ++b->n;
+}
+
+/* Each thread sums the updates to its own part of y, so no two threads add to the same entry. */
+static void
+accum_end (struct accum_bucket * mine, double * y)
+{
+     OMP(barrier);
+     const int64_t t = omp_get_thread_num ();
+     for (int64_t s = 0; s < accum_nt; ++s) {
+          const struct accum_bucket * b = &accum_buckets[s * accum_nt + t];
+          for (int64_t k = 0; k < b->n; ++k)
+               y[b->idx[k]] += b->val[k];
+     }
+     OMP(barrier);
+}
+#else
+struct accum_bucket;
+
+static inline struct accum_bucket *
+accum_begin (const int64_t nv)
+{
+     return NULL;
+}
+
 static inline void
-dspmTv_accum (const struct stinger * S, const int64_t i, const double alphaxi, double * y)
+accum_add (struct accum_bucket * mine, double * y, const int64_t j, const double val)
+{
+     atomic_daccum (&y[j], val);
+}
+
+static inline void
+accum_end (struct accum_bucket * mine, double * y)
+{
+     OMP(barrier);
+}
+#endif
+
+#if defined(ATOMIC_FP_NONE)
+/* Scaled copy of x for the gather, kept between calls and only grown when nv does */
+static double * gather_x = NULL;
+static int64_t gather_x_size = 0;
+
+/*
+ * Every edge is stored at both endpoints, so y[j] can gather what the scatter would have pushed to it.
+ * Only for the unit products: the weight of an edge is kept on its source's entry, not on the destination's.
+ */
+static inline void
+unit_dspmTv_gather (const int64_t nv, const double alpha, const struct stinger *S, const double * x, double * y,
+                    const int degscaled)
+{
+  /* Scale x once up front rather than once per edge */
+  OMP(single)
+    if (nv > gather_x_size) {
+      gather_x = xrealloc (gather_x, nv * sizeof (*gather_x));
+      gather_x_size = nv;
+    }
+  OMP(for)
+    for (int64_t i = 0; i < nv; ++i) {
+      const double alphaxi = ALPHAXI_VAL (alpha, x[i]);
+      if (degscaled) {
+        const int64_t degi = stinger_outdegree_get (S, i);
+        gather_x[i] = DEGSCALE (alphaxi, degi);
+      } else
+        gather_x[i] = alphaxi;
+    }
+
+  OMP(for schedule(guided))
+    for (int64_t j = 0; j < nv; ++j) {
+      double yj = 0.0;
+      STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_BEGIN(S, j) {
+        const int64_t i = STINGER_RO_EDGE_DEST;
+        if (i != j) yj += gather_x[i];
+      } STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_END();
+      y[j] += yj;
+    }
+}
+#endif
+
+static inline void
+dspmTv_accum (const struct stinger * S, const int64_t i, const double alphaxi, double * y, struct accum_bucket * acc)
 {
   STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_BEGIN(S, i) {
     const int64_t j = STINGER_RO_EDGE_DEST;
     if (i != j) {
-         const double aij = STINGER_RO_EDGE_WEIGHT;
-      atomic_daccum (&y[j], aij * alphaxi);
+      const double aij = STINGER_RO_EDGE_WEIGHT;
+      accum_add (acc, y, j, aij * alphaxi);
     }
   } STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_END();
 }
@@ -129,12 +261,14 @@ void stinger_dspmTv (const int64_t nv, const double alpha, const struct stinger
   OMP(parallel) {
     setup_y (nv, beta, y);
 
-    OMP(for)
+    struct accum_bucket * acc = accum_begin (nv);
+    OMP(for nowait)
       for (int64_t i = 0; i < nv; ++i) {
         const double alphaxi = ALPHAXI_VAL (alpha, x[i]);
         if (alphaxi != 0.0)
-          dspmTv_accum (S, i, alphaxi, y);
+          dspmTv_accum (S, i, alphaxi, y, acc);
       }
+    accum_end (acc, y);
   }
 }
 
@@ -143,12 +277,16 @@ void stinger_unit_dspmTv (const int64_t nv, const double alpha, const struct sti
   OMP(parallel) {
     setup_y (nv, beta, y);
 
+#if defined(ATOMIC_FP_NONE)
+    unit_dspmTv_gather (nv, alpha, S, x, y, 0);
+#else
     OMP(for)
       for (int64_t i = 0; i < nv; ++i) {
         const double alphaxi = ALPHAXI_VAL (alpha, x[i]);
         if (alphaxi != 0.0)
           dspmTv_unit_accum (S, i, alphaxi, y);
       }
+#endif
   }
 }
 
@@ -157,15 +295,17 @@ void stinger_dspmTv_degscaled (const int64_t nv, const double alpha, const struc
   OMP(parallel) {
     setup_y (nv, beta, y);
 
-    OMP(for)
+    struct accum_bucket * acc = accum_begin (nv);
+    OMP(for nowait)
       for (int64_t i = 0; i < nv; ++i) {
         const double alphaxi = ALPHAXI_VAL (alpha, x[i]);
         if (alphaxi != 0.0) {
           const int64_t degi = stinger_outdegree_get (S, i);
           const double alphaxi_deg = DEGSCALE (alphaxi, degi);
-          dspmTv_accum (S, i, alphaxi_deg, y);
+          dspmTv_accum (S, i, alphaxi_deg, y, acc);
         }
       }
+    accum_end (acc, y);
   }
 }
 
@@ -175,6 +315,9 @@ void stinger_unit_dspmTv_degscaled (const int64_t nv, const double alpha, const
   {
     setup_y (nv, beta, y);
 
+#if defined(ATOMIC_FP_NONE)
+    unit_dspmTv_gather (nv, alpha, S, x, y, 1);
+#else
     OMP(for)
       for (int64_t i = 0; i < nv; ++i) {
         const double alphaxi = ALPHAXI_VAL (alpha, x[i]);
@@ -184,6 +327,7 @@ void stinger_unit_dspmTv_degscaled (const int64_t nv, const double alpha, const
           dspmTv_unit_accum (S, i, alphaxi_deg, y);
         }
       }
+#endif
   }
 }
 
@@ -300,13 +444,13 @@ enqueue (struct batch * b, const int64_t j, int64_t * y_deg, int64_t * y_idx, in
 static inline void
 dspmTspv_accum (const struct stinger * S, const int64_t i, const double alphaxi,
                 int64_t * y_deg, int64_t * y_idx, double * y,
-                int64_t * loc_ws, struct batch *b)
+                int64_t * loc_ws, struct batch *b, struct accum_bucket * acc)
 {
   STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_BEGIN(S, i) {
     const int64_t j = STINGER_RO_EDGE_DEST;
     if (i != j) {
       const double aij = STINGER_RO_EDGE_WEIGHT;
-      atomic_daccum (&y[j], aij * alphaxi);
+      accum_add (acc, y, j, aij * alphaxi);
       if (loc_ws[j] < 0) enqueue (b, j, y_deg, y_idx, loc_ws);
     }
   } STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_END();
@@ -315,12 +459,12 @@ dspmTspv_accum (const struct stinger * S, const int64_t i, const double alphaxi,
 static inline void
 dspmTspv_unit_accum (const struct stinger * S, const int64_t i, const double alphaxi,
                      int64_t * y_deg, int64_t * y_idx, double * y,
-                     int64_t * loc_ws, struct batch *b)
+                     int64_t * loc_ws, struct batch *b, struct accum_bucket * acc)
 {
   STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_BEGIN(S, i) {
     const int64_t j = STINGER_RO_EDGE_DEST;
     if (i != j) {
-      atomic_daccum (&y[j], alphaxi);
+      accum_add (acc, y, j, alphaxi);
       if (loc_ws[j] < 0) enqueue (b, j, y_deg, y_idx, loc_ws);
     }
   } STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_END();
@@ -347,18 +491,19 @@ void stinger_dspmTspv (const int64_t nv, const double alpha, const struct stinge
     setup_workspace (nv, &loc_ws, &val_ws);
     setup_sparse_y (beta, *y_deg_ptr, y_idx, y_val, loc_ws, val_ws);
     struct batch b = BATCH_INIT;
+    struct accum_bucket * acc = accum_begin (nv);
 
     OMP(for nowait)
       for (int64_t xk = 0; xk < x_deg; ++xk) {
         const int64_t i = x_idx[xk];
         const double alphaxi = ALPHAXI_VAL (alpha, x_val[xk]);
         if (alphaxi != 0.0)
-             dspmTspv_accum (S, i, alphaxi, y_deg_ptr, y_idx, val_ws, loc_ws, &b);
+             dspmTspv_accum (S, i, alphaxi, y_deg_ptr, y_idx, val_ws, loc_ws, &b, acc);
         assert(b.n <= BATCH_SIZE);
       }
     flush (&b, y_deg_ptr, y_idx, loc_ws);
     assert(b.n == 0);
-    OMP(barrier);
+    accum_end (acc, val_ws);
 
     pack_vals (*y_deg_ptr, y_idx, val_ws, y_val);
   }
@@ -379,16 +524,17 @@ void stinger_unit_dspmTspv (const int64_t nv, const double alpha, const struct s
     setup_workspace (nv, &loc_ws, &val_ws);
     setup_sparse_y (beta, *y_deg_ptr, y_idx, y_val, loc_ws, val_ws);
     struct batch b = BATCH_INIT;
+    struct accum_bucket * acc = accum_begin (nv);
 
     OMP(for nowait)
       for (int64_t xk = 0; xk < x_deg; ++xk) {
         const int64_t i = x_idx[xk];
         const double alphaxi = ALPHAXI_VAL (alpha, x_val[xk]);
         if (alphaxi != 0.0)
-             dspmTspv_unit_accum (S, i, alphaxi, y_deg_ptr, y_idx, val_ws, loc_ws, &b);
+             dspmTspv_unit_accum (S, i, alphaxi, y_deg_ptr, y_idx, val_ws, loc_ws, &b, acc);
       }
     flush (&b, y_deg_ptr, y_idx, loc_ws);
-    OMP(barrier)
+    accum_end (acc, val_ws);
 
     pack_vals (*y_deg_ptr, y_idx, val_ws, y_val);
   }
@@ -409,6 +555,7 @@ void stinger_dspmTspv_degscaled (const int64_t nv, const double alpha, const str
     setup_workspace (nv, &loc_ws, &val_ws);
     setup_sparse_y (beta, *y_deg_ptr, y_idx, y_val, loc_ws, val_ws);
     struct batch b = BATCH_INIT;
+    struct accum_bucket * acc = accum_begin (nv);
 
     OMP(for nowait)
       for (int64_t xk = 0; xk < x_deg; ++xk) {
@@ -417,11 +564,11 @@ void stinger_dspmTspv_degscaled (const int64_t nv, const double alpha, const str
         if (alphaxi != 0.0) {
           const int64_t degi = stinger_outdegree_get (S, i);
           const double alphaxi_deg = DEGSCALE (alphaxi, degi);
-          dspmTspv_accum (S, i, alphaxi_deg, y_deg_ptr, y_idx, val_ws, loc_ws, &b);
+          dspmTspv_accum (S, i, alphaxi_deg, y_deg_ptr, y_idx, val_ws, loc_ws, &b, acc);
         }
       }
     flush (&b, y_deg_ptr, y_idx, loc_ws);
-    OMP(barrier)
+    accum_end (acc, val_ws);
 
     pack_vals (*y_deg_ptr, y_idx, val_ws, y_val);
   }
@@ -446,6 +593,7 @@ void stinger_unit_dspmTspv_degscaled (const int64_t nv, const double alpha, cons
   setup_workspace (nv, &loc_ws, &val_ws);
   setup_sparse_y (beta, *y_deg_ptr, y_idx, y_val, loc_ws, val_ws);
   struct batch b = BATCH_INIT;
+  struct accum_bucket * acc = accum_begin (nv);
 
   OMP(for nowait schedule(guided) reduction(+: vol)) // reduction(+: tugh, tugh2)")
     for (int64_t xk = 0; xk < x_deg; ++xk) {
@@ -458,12 +606,12 @@ void stinger_unit_dspmTspv_degscaled (const int64_t nv, const double alpha, cons
         const double alphaxi_deg = DEGSCALE (alphaxi, degi);
         vol += degi;
         /* const double ti2 = omp_get_wtime(); */
-        dspmTspv_unit_accum (S, i, alphaxi_deg, y_deg_ptr, y_idx, val_ws, loc_ws, &b);
+        dspmTspv_unit_accum (S, i, alphaxi_deg, y_deg_ptr, y_idx, val_ws, loc_ws, &b, acc);
         /* tugh2 += omp_get_wtime()-ti2; */
       }
     }
   flush (&b, y_deg_ptr, y_idx, loc_ws);
-  OMP(barrier);
+  accum_end (acc, val_ws);
 
   pack_vals (*y_deg_ptr, y_idx, val_ws, y_val);
 
@@ -490,6 +638,7 @@ void stinger_unit_dspmTspv_degscaled_held (const double holdthresh, const int64_
   setup_workspace (nv, &loc_ws, &val_ws);
   setup_sparse_y (beta, *y_deg_ptr, y_idx, y_val, loc_ws, val_ws);
   struct batch b = BATCH_INIT;
+  struct accum_bucket * acc = accum_begin (nv);
 
   OMP(for nowait schedule(guided) reduction(+: vol)) // reduction(+: tugh, tugh2)")
     for (int64_t xk = 0; xk < x_deg; ++xk) {
@@ -503,7 +652,7 @@ void stinger_unit_dspmTspv_degscaled_held (const double holdthresh, const int64_
         const double alphaxi_deg = DEGSCALE (alphaxi, degi);
         vol += degi;
         /* const double ti2 = omp_get_wtime(); */
-        dspmTspv_unit_accum (S, i, alphaxi_deg, y_deg_ptr, y_idx, val_ws, loc_ws, &b);
+        dspmTspv_unit_accum (S, i, alphaxi_deg, y_deg_ptr, y_idx, val_ws, loc_ws, &b, acc);
         /* tugh2 += omp_get_wtime()-ti2; */
       } else {
         /* already in pattern... */
@@ -511,7 +660,7 @@ void stinger_unit_dspmTspv_degscaled_held (const double holdthresh, const int64_
       }
     }
   flush (&b, y_deg_ptr, y_idx, loc_ws);
-  OMP(barrier);
+  accum_end (acc, val_ws);
 
   pack_vals (*y_deg_ptr, y_idx, val_ws, y_val);
 
@@ -9,4 +9,11 @@
 
 int64_t parallel_shiloach_vishkin_components (struct stinger * S, int64_t nv, int64_t * component_map);
 
+/*
+ * Labels each weakly connected component with its smallest vertex ID, like parallel_shiloach_vishkin_components
+ * on an undirected graph. Links a few edges of every vertex first, then only searches the rest of the edges of
+ * vertices outside the largest component found so far (Afforest).
+ */
+int64_t afforest_components (struct stinger * S, int64_t nv, int64_t * component_map);
+
 #endif
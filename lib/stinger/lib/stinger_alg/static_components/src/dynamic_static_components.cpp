@@ -28,7 +28,7 @@ ConnectedComponents::onInit(stinger_registered_alg * alg)
 {
     components = (int64_t *)alg->alg_data;
 
-    parallel_shiloach_vishkin_components(alg->stinger, alg->max_active_vertex+1, components);
+    afforest_components(alg->stinger, alg->max_active_vertex+1, components);
 }
 
 void
@@ -40,5 +40,5 @@ ConnectedComponents::onPre(stinger_registered_alg * alg)
 void
 ConnectedComponents::onPost(stinger_registered_alg * alg)
 {
-    parallel_shiloach_vishkin_components(alg->stinger, alg->max_active_vertex+1, components);
+    afforest_components(alg->stinger, alg->max_active_vertex+1, components);
 }
@@ -1,5 +1,7 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "static_components.h"
+#include "stinger_core/stinger_atomics.h"
 
 /*
  * Perform a shiloach vishkin connected components calculation in parallel on a stinger graph
@@ -47,3 +49,118 @@ parallel_shiloach_vishkin_components (struct stinger * S, int64_t nv,
 
   return 0;
 }
+
+/* Number of edges of each vertex to link before looking for the largest component */
+#define AFFOREST_NEIGHBOR_ROUNDS 2
+/* Number of vertices to sample when looking for the largest component */
+#define AFFOREST_NUM_SAMPLES 1024
+
+/*
+ * Merges the trees holding u and v. Roots are only ever pointed at a smaller vertex,
+ * so each tree's root is its smallest vertex.
+ */
+static void
+afforest_link (int64_t u, int64_t v, int64_t * component_map)
+{
+  int64_t p1 = component_map[u];
+  int64_t p2 = component_map[v];
+  while (p1 != p2) {
+    int64_t high = p1 > p2 ? p1 : p2;
+    int64_t low = p1 + p2 - high;
+    int64_t p_high = component_map[high];
+    /* Already linked, or we won the race to link the root */
+    if (p_high == low || (p_high == high && stinger_int64_cas (&component_map[high], high, low) == high))
+      break;
+    p1 = component_map[component_map[high]];
+    p2 = component_map[low];
+  }
+}
+
+static void
+afforest_compress (int64_t nv, int64_t * component_map)
+{
+  OMP ("omp parallel for schedule(dynamic, 16384)")
+    for (int64_t i = 0; i < nv; i++) {
+      while (component_map[i] != component_map[component_map[i]]) {
+        component_map[i] = component_map[component_map[i]];
+      }
+    }
+}
+
+static int
+compare_int64 (const void * a, const void * b)
+{
+  int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* Guesses the label of the largest component from a sample of the vertices */
+static int64_t
+afforest_sample_largest (int64_t nv, const int64_t * component_map)
+{
+  int64_t samples[AFFOREST_NUM_SAMPLES];
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  for (int64_t k = 0; k < AFFOREST_NUM_SAMPLES; k++) {
+    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+    samples[k] = component_map[state % nv];
+  }
+  qsort (samples, AFFOREST_NUM_SAMPLES, sizeof(int64_t), compare_int64);
+
+  int64_t best = samples[0], best_count = 0;
+  for (int64_t k = 0, run = 0; k < AFFOREST_NUM_SAMPLES; k++) {
+    run = (k > 0 && samples[k] == samples[k-1]) ? run + 1 : 1;
+    if (run > best_count) {
+      best = samples[k];
+      best_count = run;
+    }
+  }
+  return best;
+}
+
+/*
+ * Afforest connected components (Sutton et al., IPDPS 2018) on a stinger graph.
+ * Each edge is stored with both of its endpoints, so edges are followed in both directions.
+ */
+int64_t
+afforest_components (struct stinger * S, int64_t nv, int64_t * component_map)
+{
+  if (nv <= 0) { return 0; }
+
+  OMP ("omp parallel for")
+    for (int64_t i = 0; i < nv; i++) {
+      component_map[i] = i;
+    }
+
+  /* Link the first few edges of each vertex, one round at a time */
+  for (int64_t round = 0; round < AFFOREST_NEIGHBOR_ROUNDS; round++) {
+    OMP ("omp parallel for schedule(dynamic, 16384)")
+      for (int64_t u = 0; u < nv; u++) {
+        int64_t k = 0;
+        STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_BEGIN (S, u) {
+          /* break only leaves the current edge block */
+          if (k > round) break;
+          if (k++ == round) {
+            afforest_link (u, STINGER_RO_EDGE_DEST, component_map);
+          }
+        } STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_END ();
+      }
+    afforest_compress (nv, component_map);
+  }
+
+  /* Most vertices are in the largest component by now. Every edge is stored with both endpoints,
+     so the remaining edges can be linked from whichever endpoint is outside of it. */
+  int64_t largest = afforest_sample_largest (nv, component_map);
+  OMP ("omp parallel for schedule(dynamic, 16384)")
+    for (int64_t u = 0; u < nv; u++) {
+      if (component_map[u] == largest) continue;
+      int64_t k = 0;
+      STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_BEGIN (S, u) {
+        if (k++ >= AFFOREST_NEIGHBOR_ROUNDS) {
+          afforest_link (u, STINGER_RO_EDGE_DEST, component_map);
+        }
+      } STINGER_READ_ONLY_FORALL_EDGES_OF_VTX_END ();
+    }
+  afforest_compress (nv, component_map);
+
+  return 0;
+}
@@ -30,6 +30,8 @@
 #include <cmath>
 
 #include <dynograph_edge_count.h>
+#include <hooks_c.h>
+#include <update_latency.h>
 
 // *** Public interface (definitions at end of file) ***
 template<typename adapter, typename iterator>
@@ -259,9 +261,10 @@ protected:
             if(type == tmp->etype) {
                 size_t k, endk;
                 endk = tmp->high;
+                // Every edge in the block will be visited
+                DYNOGRAPH_EDGE_COUNT_TRAVERSE_MULTIPLE_EDGES(endk);
                 // For each edge in the block
                 for (k = 0; k < endk; ++k) {
-                    DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
                     // Mask off direction bits to get the raw neighbor of this edge
                     int64_t dest = (tmp->edges[k].neighbor & (~STINGER_EDGE_DIRECTION_MASK));
                     // Find updates for this destination
@@ -384,6 +387,7 @@ protected:
 
         // Sort by type, src, dst, time ascending
         LOG_V("Sorting...");
+        DYNOGRAPH_SUBREGION_BEGIN("sort");
         std::sort(updates_begin, updates_end, use_source::sort);
 
         // Get a list of pointers to each element
@@ -437,10 +441,12 @@ protected:
             OMP("omp critical")
             update_ranges.insert(update_ranges.end(), local_ranges.begin(), local_ranges.end());
         }
+        DYNOGRAPH_SUBREGION_END();
 
 
         LOG_V_A("Entering parallel update loop: %ld updates for %ld vertices.",
             std::distance(updates_begin, updates_end), unique_sources.size()-1);
+        DYNOGRAPH_SUBREGION_BEGIN("update");
         OMP("omp parallel for schedule(dynamic)")
         for (range_iterator range = update_ranges.begin(); range < update_ranges.end(); ++range)
         {
@@ -452,8 +458,22 @@ protected:
             int64_t source = use_source::get(*begin);
 
             LOG_D_A("Thread %d processing %ld updates (%ld -> *)", omp_get_thread_num(), std::distance(begin, end), source);
+            // All the updates for this vertex complete together
+            DYNOGRAPH_UPDATE_LATENCY_BEGIN(std::distance(begin, end));
             update_directed_edges_for_vertex<direction, use_dest>(G, source, type, begin, end, operation);
+            DYNOGRAPH_UPDATE_LATENCY_END();
         }
+        DYNOGRAPH_SUBREGION_END();
+    }
+
+    // Update one direction of each edge, recording the time for each pass
+    template<int64_t direction, class use_source, class use_dest>
+    static void
+    do_batch_update_pass(stinger_t * G, iterator updates_begin, iterator updates_end, int64_t operation)
+    {
+        DYNOGRAPH_SUBREGION_BEGIN(direction == STINGER_EDGE_DIRECTION_OUT ? "out_pass" : "in_pass");
+        do_batch_update<direction, use_source, use_dest>(G, updates_begin, updates_end, operation);
+        DYNOGRAPH_SUBREGION_END();
     }
 
     static bool
@@ -523,24 +543,26 @@ protected:
         // Second iteration: group by destination and update in-edges
         // But, in order to avoid deadlock with concurrent deletions, we must always lock edges in the same order
         LOG_V("Partitioning batch to obey ordering constraints...");
+        DYNOGRAPH_SUBREGION_BEGIN("partition");
         const iterator pos = std::partition(updates_begin, updates_end, source_less_than_destination);
+        DYNOGRAPH_SUBREGION_END();
 
         const int64_t OUT = STINGER_EDGE_DIRECTION_OUT;
         const int64_t IN = STINGER_EDGE_DIRECTION_IN;
 
         // All elements between begin and pos have src < dest. Update the out-edge slot first
         LOG_V("Beginning OUT updates for first half of batch...");
-        do_batch_update<OUT, source_funcs, dest_funcs>(G, updates_begin, pos, operation);
+        do_batch_update_pass<OUT, source_funcs, dest_funcs>(G, updates_begin, pos, operation);
         clear_results(updates_begin, pos);
         LOG_V("Beginning IN updates for first half of batch...");
-        do_batch_update<IN, dest_funcs, source_funcs>(G, updates_begin, pos, operation);
+        do_batch_update_pass<IN, dest_funcs, source_funcs>(G, updates_begin, pos, operation);
 
         // All elements between pos and end have src > dest. Update the in-edge slot first
         LOG_V("Beginning IN updates for second half of batch...");
-        do_batch_update<IN, dest_funcs, source_funcs>(G, pos, updates_end, operation);
+        do_batch_update_pass<IN, dest_funcs, source_funcs>(G, pos, updates_end, operation);
         clear_results(pos, updates_end);
         LOG_V("Beginning OUT updates for second half of batch...");
-        do_batch_update<OUT, source_funcs, dest_funcs>(G, pos, updates_end, operation);
+        do_batch_update_pass<OUT, source_funcs, dest_funcs>(G, pos, updates_end, operation);
 
         // For undirected, do the same updates again in the opposite direction
         if (!directed)
@@ -549,14 +571,14 @@ protected:
             clear_results(updates_begin, updates_end);
 
             // All elements between begin and pos have dest < src. Update the in-edge slot first
-            do_batch_update<OUT, dest_funcs, source_funcs>(G, updates_begin, pos, operation);
+            do_batch_update_pass<OUT, dest_funcs, source_funcs>(G, updates_begin, pos, operation);
             clear_results(updates_begin, pos);
-            do_batch_update<IN, source_funcs, dest_funcs>(G, updates_begin, pos, operation);
+            do_batch_update_pass<IN, source_funcs, dest_funcs>(G, updates_begin, pos, operation);
 
             // All elements between pos and end have dest > src. Update the out-edge slot first
-            do_batch_update<IN, source_funcs, dest_funcs>(G, pos, updates_end, operation);
+            do_batch_update_pass<IN, source_funcs, dest_funcs>(G, pos, updates_end, operation);
             clear_results(pos, updates_end);
-            do_batch_update<OUT, dest_funcs, source_funcs>(G, pos, updates_end, operation);
+            do_batch_update_pass<OUT, dest_funcs, source_funcs>(G, pos, updates_end, operation);
         }
 
         remap_results(updates_begin, updates_end);
@@ -130,17 +130,19 @@ extern "C" {
       int64_t source__ = current_eb__->vertexID;                                                          \
       int64_t type__ = current_eb__->etype;                                                               \
       EB_FILTER_ {                                                                                        \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();                                                               \
         PARALLEL_                                                                                         \
         for(uint64_t i__ = 0; i__ < stinger_eb_high(current_eb__); i__++) {                               \
           if(!stinger_eb_is_blank(current_eb__, i__)) {                                                   \
             struct stinger_edge * current_edge__ = current_eb__->edges + i__;                             \
             EDGE_FILTER_ {                                                                                \
-              DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+              DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
 
 #define STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()         \
             } /* end EDGE_FILTER_ */                      \
           } /* end if eb blank */                         \
         } /* end for edges in eb */                       \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_END();                 \
       } /* end EB_FILTER_ */                              \
       current_eb__ = ebpool_priv + (current_eb__->next);  \
     } /* end while not last edge */                       \
@@ -197,40 +199,44 @@ extern "C" {
 #define STINGER_FORALL_ENABLE_PARALLEL_ \
   OMP("omp parallel for")               \
   
+// Parallel loop over the edges in a block, summing up the local edge count from each thread
+#define STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_ \
+  OMP("omp parallel for reduction(+:dynograph_edge_count_local__)")
+
 
 // For all edges of vertex, in parallel
 #define STINGER_PARALLEL_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_) \
-  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,,,STINGER_FORALL_ENABLE_PARALLEL_)
+  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,,,STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_)
 #define STINGER_PARALLEL_FORALL_EDGES_OF_VTX_END() \
   STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()
 
 // For all out-edges of vertex, in parallel
 #define STINGER_PARALLEL_FORALL_OUT_EDGES_OF_VTX_BEGIN(STINGER_,VTX_) \
-  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_OUT_EDGE),,STINGER_FORALL_ENABLE_PARALLEL_)
+  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_OUT_EDGE),,STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_)
 #define STINGER_PARALLEL_FORALL_OUT_EDGES_OF_VTX_END() \
   STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()
 
 // For all in-edges of vertex, in parallel
 #define STINGER_PARALLEL_FORALL_IN_EDGES_OF_VTX_BEGIN(STINGER_,VTX_) \
-  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_IN_EDGE),,STINGER_FORALL_ENABLE_PARALLEL_)
+  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_IN_EDGE),,STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_)
 #define STINGER_PARALLEL_FORALL_IN_EDGES_OF_VTX_END() \
   STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()
 
 // For all edges of vertex of a certain edge type, in parallel
 #define STINGER_PARALLEL_FORALL_EDGES_OF_TYPE_OF_VTX_BEGIN(STINGER_,TYPE_,VTX_) \
-  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,,if (current_eb__->etype == TYPE_),STINGER_FORALL_ENABLE_PARALLEL_)
+  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,,if (current_eb__->etype == TYPE_),STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_)
 #define STINGER_PARALLEL_FORALL_EDGES_OF_TYPE_OF_VTX_END() \
   STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()
 
 // For all out-edges of vertex of a certain edge type, in parallel
 #define STINGER_PARALLEL_FORALL_OUT_EDGES_OF_TYPE_OF_VTX_BEGIN(STINGER_,TYPE_,VTX_) \
-  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_OUT_EDGE),if (current_eb__->etype == TYPE_),STINGER_FORALL_ENABLE_PARALLEL_)
+  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_OUT_EDGE),if (current_eb__->etype == TYPE_),STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_)
 #define STINGER_PARALLEL_FORALL_OUT_EDGES_OF_TYPE_OF_VTX_END() \
   STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()
 
 // For all out-edges of vertex of a certain edge type, in parallel
 #define STINGER_PARALLEL_FORALL_IN_EDGES_OF_TYPE_OF_VTX_BEGIN(STINGER_,TYPE_,VTX_) \
-  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_IN_EDGE),if (current_eb__->etype == TYPE_),STINGER_FORALL_ENABLE_PARALLEL_)
+  STINGER_GENERIC_FORALL_EDGES_OF_VTX_BEGIN(STINGER_,VTX_,if (STINGER_IS_IN_EDGE),if (current_eb__->etype == TYPE_),STINGER_FORALL_EDGES_OF_VTX_ENABLE_PARALLEL_)
 #define STINGER_PARALLEL_FORALL_IN_EDGES_OF_TYPE_OF_VTX_END() \
   STINGER_GENERIC_FORALL_EDGES_OF_VTX_END()
 
@@ -245,15 +251,17 @@ extern "C" {
         struct stinger_eb *  current_eb__ = ebpool_priv+ ETA((STINGER_),(t__))->blocks[p__];  \
         int64_t source__ = current_eb__->vertexID;                                            \
         int64_t type__ = current_eb__->etype;                                                 \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();                                                   \
         for(uint64_t i__ = 0; i__ < stinger_eb_high(current_eb__); i__++) {                   \
           if(!stinger_eb_is_blank(current_eb__, i__)) {                                       \
             struct stinger_edge * current_edge__ = current_eb__->edges + i__;                 \
             if (STINGER_IS_OUT_EDGE) {                                                        \
-              DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+              DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
 #define STINGER_GENERIC_FORALL_EDGES_END()  \
             } /* end if is out edge */      \
           } /* end if eb is blank */        \
         } /* end for edges in eb */         \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_END();   \
       } /* for each edge of type t__ */     \
     } /* END_SELECT_TYPE */                 \
   } while (0)
@@ -293,13 +301,15 @@ extern "C" {
         struct stinger_eb *  current_eb__ = ebpool_priv+ ETA((STINGER_),(t__))->blocks[p__];  \
         int64_t source__ = current_eb__->vertexID;                                            \
         int64_t type__ = current_eb__->etype;                                                 \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();                                                   \
         for(uint64_t i__ = 0; i__ < stinger_eb_high(current_eb__); i__++) {                   \
           if(!stinger_eb_is_blank(current_eb__, i__)) {                                       \
             struct stinger_edge * current_edge__ = current_eb__->edges + i__;                 \
-            DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+            DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
 #define STINGER_RAW_FORALL_EDGES_OF_ALL_TYPES_END()  \
           } /* end if eb is blank */        \
         } /* end for edges in eb */         \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_END();   \
       } /* for each edge of type t__ */     \
     } /* END_SELECT_TYPE */                 \
   } while (0)
@@ -315,17 +325,19 @@ extern "C" {
     int64_t ebp_k__ = vertices->vertices[source__].edges;                               \
     while(ebp_k__) {                                                                    \
       EB_FILTER_ {                                                                      \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();                                             \
         for(uint64_t i__ = 0; i__ < ebp__[ebp_k__].high; i__++) {                       \
           if(!stinger_eb_is_blank(&ebp__[ebp_k__], i__)) {                              \
             const struct stinger_edge local_current_edge__ = ebp__[ebp_k__].edges[i__]; \
             if(local_current_edge__.neighbor >= 0) {                                    \
               EDGE_FILTER_ {                                                            \
-                DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+                DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
 #define STINGER_GENERIC_READ_ONLY_FORALL_EDGES_OF_VTX_END() \
               } /* end EDGE_FILTER_ */              \
             } /* end if neighbor exists */          \
           } /* end if eb is blank */                \
         } /* end for all eb's */                    \
+        DYNOGRAPH_EDGE_COUNT_LOCAL_END();           \
       } /* end EB_FILTER_ */                        \
       ebp_k__ = ebp__[ebp_k__].next;                \
     } /* end while ebp_k__ valid */                 \
@@ -446,15 +458,17 @@ extern "C" {
           int64_t ebp_k__ = ETA((STINGER_),(TYPE_))->blocks[p__];              \
           const int64_t source__ = ebp__[ebp_k__].vertexID;             \
           const int64_t type__ = ebp__[ebp_k__].etype;                  \
+          DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();                           \
           for(uint64_t i__ = 0; i__ < ebp__[ebp_k__].high; i__++) {     \
             if(!stinger_eb_is_blank(&ebp__[ebp_k__], i__)) {            \
               const struct stinger_edge local_current_edge__ = ebp__[ebp_k__].edges[i__]; \
               if(local_current_edge__.neighbor >= 0) { \
-                 DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+                 DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
 #define STINGER_READ_ONLY_FORALL_EDGES_END()                            \
               }                                                         \
             }                                                           \
           }                                                             \
+          DYNOGRAPH_EDGE_COUNT_LOCAL_END();                             \
         }                                                               \
       } while (0)
 
@@ -470,15 +484,17 @@ extern "C" {
           int64_t ebp_k__ = ETA((STINGER_),(TYPE_))->blocks[p__];          \
           const int64_t source__ = ebp__[ebp_k__].vertexID;         \
           const int64_t type__ = ebp__[ebp_k__].etype;              \
+          DYNOGRAPH_EDGE_COUNT_LOCAL_BEGIN();                       \
           for(uint64_t i__ = 0; i__ < ebp__[ebp_k__].high; i__++) { \
             if(!stinger_eb_is_blank(&ebp__[ebp_k__], i__)) {      \
               const struct stinger_edge local_current_edge__ = ebp__[ebp_k__].edges[i__]; \
               if(local_current_edge__.neighbor >= 0) { \
-                DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
+                DYNOGRAPH_EDGE_COUNT_LOCAL_TRAVERSE_EDGE();
 #define STINGER_READ_ONLY_PARALLEL_FORALL_EDGES_END()                   \
               }                                                   \
             }                                                     \
           }                                                       \
+          DYNOGRAPH_EDGE_COUNT_LOCAL_END();                       \
         }                                                           \
       } while (0)
 
@@ -1188,8 +1188,8 @@ stinger_update_directed_edge(struct stinger *G,
       endk = tmp->high;
 
       for (k = 0; k < endk; ++k) {
-        DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
         if (dest == (tmp->edges[k].neighbor & (~STINGER_EDGE_DIRECTION_MASK))) {
+          DYNOGRAPH_EDGE_COUNT_TRAVERSE_MULTIPLE_EDGES(k + 1);
           int ret = 0;
           if (direction & tmp->edges[k].neighbor) {
             ret = 0;
@@ -1200,6 +1200,7 @@ stinger_update_directed_edge(struct stinger *G,
           return ret;
         }
       }
+      DYNOGRAPH_EDGE_COUNT_TRAVERSE_MULTIPLE_EDGES(endk);
     }
   }
 
@@ -135,10 +135,207 @@ TEST_F(BetweennessTest, UndirectedGraph) {
   }
 }
 
+TEST_F(BetweennessTest, EngineReusedBetweenSearches) {
+  stinger_insert_edge_pair(S, 0, 0, 1, 1, 1);
+  stinger_insert_edge_pair(S, 0, 1, 2, 1, 1);
+  stinger_insert_edge_pair(S, 0, 1, 3, 1, 1);
+  stinger_insert_edge_pair(S, 0, 1, 4, 1, 1);
+  stinger_insert_edge_pair(S, 0, 2, 8, 1, 1);
+  stinger_insert_edge_pair(S, 0, 3, 5, 1, 1);
+  stinger_insert_edge_pair(S, 0, 3, 6, 1, 1);
+  stinger_insert_edge_pair(S, 0, 4, 5, 1, 1);
+  stinger_insert_edge_pair(S, 0, 5, 6, 1, 1);
+  stinger_insert_edge_pair(S, 0, 5, 7, 1, 1);
+  stinger_insert_edge_pair(S, 0, 7, 8, 1, 1);
+
+  int64_t max_nv = 64;
+  bc_engine_t * engine = bc_engine_new(max_nv);
+  double * bc = (double *)xcalloc(max_nv, sizeof(double));
+  int64_t * times_found = (int64_t *)xcalloc(max_nv, sizeof(int64_t));
+  double * expected_bc = (double *)xcalloc(max_nv, sizeof(double));
+  int64_t * expected_times_found = (int64_t *)xcalloc(max_nv, sizeof(int64_t));
+
+  // Results from a reused engine match a fresh search, even after the graph changes
+  int64_t sources[4] = {0, 5, 8, 5};
+  for (int64_t round = 0; round < 3; round++) {
+    int64_t nv = stinger_max_active_vertex(S)+1;
+    bc_engine_search(engine, S, nv, 4, sources, bc, times_found);
+    sample_search_custom(S, nv, 4, sources, expected_bc, expected_times_found);
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_NEAR(expected_bc[v], bc[v], 0.00001) << "round = " << round << ", v = " << v;
+      EXPECT_EQ(expected_times_found[v], times_found[v]) << "round = " << round << ", v = " << v;
+    }
+    stinger_insert_edge_pair(S, 0, 8, 9 + round, 1, 1);
+    stinger_remove_edge_pair(S, 0, 1, 3);
+  }
+
+  // A source isn't found by its own search
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  bc_engine_search(engine, S, nv, 4, sources, bc, times_found);
+  EXPECT_EQ(3, times_found[0]);
+  EXPECT_EQ(2, times_found[5]);
+
+  bc_engine_free(engine);
+  xfree(bc);
+  xfree(times_found);
+  xfree(expected_bc);
+  xfree(expected_times_found);
+}
+
+static stinger_edge_update
+edge(int64_t u, int64_t v)
+{
+  stinger_edge_update e = {};
+  e.source = u;
+  e.destination = v;
+  return e;
+}
+
+TEST_F(BetweennessTest, IncrementalMatchesFullSearch) {
+  // A path with some shortcuts
+  const int64_t n = 60;
+  for (int64_t v = 0; v < n - 1; v++) {
+    stinger_insert_edge(S, 0, v, v + 1, 1, 1);
+    stinger_insert_edge(S, 0, v, (v * 7 + 3) % n, 1, 1);
+  }
+
+  // Keep results for the first two sources, search from the other two every time
+  std::vector<int64_t> sources = {0, 20, 5, 40};
+  gt::stinger::BetweennessCentrality bc(sources.size(), 0.5, 0,
+    gt::stinger::BetweennessCentrality::INCREMENTAL, 2);
+  bc.setSources(sources);
+  std::vector<uint8_t> data(S->max_nv * bc.getDataPerVertex());
+  double * result = (double *)data.data();
+  int64_t * times_found = (int64_t *)(result + S->max_nv);
+  stinger_registered_alg alg = {};
+  alg.stinger = S;
+  alg.alg_data = data.data();
+  alg.max_active_vertex = stinger_max_active_vertex(S);
+  bc.onInit(&alg);
+
+  std::vector<double> expected_bc(S->max_nv);
+  std::vector<int64_t> expected_times_found(S->max_nv);
+  std::vector<std::vector<stinger_edge_update>> insertions = {
+    // Lowers distances
+    {edge(0, 50), edge(20, 59)},
+    // Adds a path on the next level, without changing distances
+    {edge(0, 4)},
+    // Doesn't change anything for the tracked sources
+    {edge(59, 0), edge(45, 44)},
+    {},
+    // Connects vertices that weren't active before
+    {edge(30, 70), edge(70, 71)},
+  };
+  std::vector<std::vector<stinger_edge_update>> deletions = {
+    {},
+    {edge(5, 6)},
+    {},
+    // Raises distances
+    {edge(0, 50), edge(0, 1), edge(20, 21)},
+    {edge(44, 45)},
+  };
+  for (size_t round = 0; round < insertions.size(); round++) {
+    for (const stinger_edge_update &e : deletions[round]) { stinger_remove_edge(S, 0, e.source, e.destination); }
+    for (const stinger_edge_update &e : insertions[round]) { stinger_insert_edge(S, 0, e.source, e.destination, 1, 1); }
+    alg.insertions = insertions[round].data();
+    alg.num_insertions = insertions[round].size();
+    alg.deletions = deletions[round].data();
+    alg.num_deletions = deletions[round].size();
+    alg.max_active_vertex = stinger_max_active_vertex(S);
+    bc.onPre(&alg);
+    bc.onPost(&alg);
+
+    int64_t nv = alg.max_active_vertex + 1;
+    sample_search_custom(S, nv, sources.size(), sources.data(), expected_bc.data(), expected_times_found.data());
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_NEAR(expected_bc[v], result[v], 0.00001) << "round = " << round << ", v = " << v;
+      EXPECT_EQ(expected_times_found[v], times_found[v]) << "round = " << round << ", v = " << v;
+    }
+  }
+
+  // Another trial in the same epoch gets the same results
+  std::vector<uint8_t> first_trial = data;
+  std::fill(data.begin(), data.end(), 0);
+  bc.onPost(&alg);
+  EXPECT_EQ(first_trial, data);
+
+  // A different set of sources
+  sources = {40, 1, 20};
+  bc.setSources(sources);
+  alg.num_insertions = 0;
+  alg.num_deletions = 0;
+  bc.onPre(&alg);
+  bc.onPost(&alg);
+  int64_t nv = alg.max_active_vertex + 1;
+  sample_search_custom(S, nv, sources.size(), sources.data(), expected_bc.data(), expected_times_found.data());
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_NEAR(expected_bc[v], result[v], 0.00001) << "v = " << v;
+    EXPECT_EQ(expected_times_found[v], times_found[v]) << "v = " << v;
+  }
+}
+
+// bc_updating blends each epoch into the previous scores the same way bc does, so the two are comparable
+TEST_F(BetweennessTest, IncrementalWeightedMatchesWeighted) {
+  const int64_t n = 40;
+  for (int64_t v = 0; v < n - 1; v++) {
+    stinger_insert_edge(S, 0, v, v + 1, 1, 1);
+    stinger_insert_edge(S, 0, v, (v * 5 + 2) % n, 1, 1);
+  }
+
+  std::vector<int64_t> sources = {0, 10, 25};
+  gt::stinger::BetweennessCentrality full(sources.size(), 0.5, 1);
+  gt::stinger::BetweennessCentrality incremental(sources.size(), 0.5, 1,
+    gt::stinger::BetweennessCentrality::INCREMENTAL, 2);
+  gt::stinger::BetweennessCentrality * algs[] = {&full, &incremental};
+  std::vector<uint8_t> data[2];
+  stinger_registered_alg alg[2] = {};
+  for (int i = 0; i < 2; i++) {
+    algs[i]->setSources(sources);
+    data[i].resize(S->max_nv * algs[i]->getDataPerVertex());
+    alg[i].stinger = S;
+    alg[i].alg_data = data[i].data();
+    alg[i].max_active_vertex = stinger_max_active_vertex(S);
+    algs[i]->onInit(&alg[i]);
+  }
+
+  std::vector<std::vector<stinger_edge_update>> insertions = {
+    {edge(0, 30)},
+    {edge(10, 39), edge(3, 2)},
+    {},
+  };
+  std::vector<std::vector<stinger_edge_update>> deletions = {
+    {},
+    {edge(0, 1)},
+    {edge(0, 30)},
+  };
+  for (size_t round = 0; round < insertions.size(); round++) {
+    for (const stinger_edge_update &e : deletions[round]) { stinger_remove_edge(S, 0, e.source, e.destination); }
+    for (const stinger_edge_update &e : insertions[round]) { stinger_insert_edge(S, 0, e.source, e.destination, 1, 1); }
+    for (int i = 0; i < 2; i++) {
+      alg[i].insertions = insertions[round].data();
+      alg[i].num_insertions = insertions[round].size();
+      alg[i].deletions = deletions[round].data();
+      alg[i].num_deletions = deletions[round].size();
+      alg[i].max_active_vertex = stinger_max_active_vertex(S);
+      algs[i]->onPre(&alg[i]);
+      algs[i]->onPost(&alg[i]);
+    }
+
+    const double * expected = (const double *)data[0].data();
+    const double * actual = (const double *)data[1].data();
+    for (int64_t v = 0; v < n; v++) {
+      EXPECT_NEAR(expected[v], actual[v], 0.00001) << "round = " << round << ", v = " << v;
+    }
+  }
+}
+
 int
 main (int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
+  // The traversal macros count edges, so the counters must exist even though we don't read them
+  // Hooks owns the counters (BetweennessCentrality also reports stats through it)
+  Hooks::getInstance();
   return RUN_ALL_TESTS();
 }
 
@@ -6,6 +6,8 @@ extern "C" {
   #include "stinger_core/stinger.h"
 }
 
+#include "stinger_alg/dynamic_betweenness.h"
+#include <hooks.h>
 #include "gtest/gtest.h"
 
 
@@ -0,0 +1,284 @@
+#include "bfs_test.h"
+
+#include <string>
+#include <vector>
+
+#define restrict
+
+class BFSTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    stinger_config = (struct stinger_config_t *)xcalloc(1,sizeof(struct stinger_config_t));
+    stinger_config->nv = 1<<13;
+    stinger_config->nebs = 1<<16;
+    stinger_config->netypes = 2;
+    stinger_config->nvtypes = 2;
+    stinger_config->memory_size = 1<<30;
+    S = stinger_new_full(stinger_config);
+    xfree(stinger_config);
+  }
+
+  virtual void TearDown() {
+    stinger_free_all(S);
+  }
+
+  // Levels from each source, found by running parallel_breadth_first_search once per source
+  std::vector<std::vector<int64_t>> search_each_source(int64_t nv, const std::vector<int64_t> &sources) {
+    std::vector<int64_t> queue(nv), Qhead(nv + 2);
+    std::vector<std::vector<int64_t>> levels;
+    for (int64_t source : sources) {
+      std::vector<int64_t> level(nv);
+      parallel_breadth_first_search(S, nv, source, queue.data(), Qhead.data(), level.data());
+      levels.push_back(level);
+    }
+    return levels;
+  }
+
+  void check_multi_source(const std::vector<int64_t> &sources) {
+    int64_t nv = stinger_max_active_vertex(S)+1;
+    int64_t num_sources = sources.size();
+    std::vector<std::vector<int64_t>> expected = search_each_source(nv, sources);
+
+    std::vector<uint64_t> seen(nv), frontier(nv), next(nv);
+    std::vector<int64_t> level(nv), all_levels(nv * num_sources);
+    multi_source_breadth_first_search(S, nv, sources.data(), num_sources,
+      seen.data(), frontier.data(), next.data(), level.data(), all_levels.data());
+
+    for (int64_t s = 0; s < num_sources; s++) {
+      for (int64_t v = 0; v < nv; v++) {
+        EXPECT_EQ(expected[s][v], all_levels[s * nv + v]) << "source = " << sources[s] << ", v = " << v;
+      }
+    }
+    // The level array matches running each search in order
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_EQ(expected.back()[v], level[v]) << "v = " << v;
+    }
+  }
+
+  // Runs a direction-optimizing search from each source and checks the levels, returns the directions of every step
+  std::string check_direction_optimizing(const std::vector<int64_t> &sources, double alpha, double beta) {
+    int64_t nv = stinger_max_active_vertex(S)+1;
+    std::vector<std::vector<int64_t>> expected = search_each_source(nv, sources);
+
+    std::vector<int64_t> queue(nv), Qhead(nv + 2), level(nv);
+    std::vector<uint64_t> frontier_bits((nv + 63) / 64);
+    std::vector<char> directions(nv);
+    std::string all_directions;
+    for (size_t s = 0; s < sources.size(); s++) {
+      int64_t levels = direction_optimizing_parallel_breadth_first_search(S, nv, sources[s],
+        queue.data(), Qhead.data(), level.data(), frontier_bits.data(), alpha, beta, directions.data());
+      for (int64_t v = 0; v < nv; v++) {
+        EXPECT_EQ(expected[s][v], level[v]) << "source = " << sources[s] << ", v = " << v;
+      }
+      all_directions.append(directions.data(), levels - 1);
+    }
+    return all_directions;
+  }
+
+  // Applies a batch of changes to the graph, then runs the incremental search and checks it against a full search
+  void check_incremental(gt::stinger::BreadthFirstSearch &bfs, stinger_registered_alg &alg, int64_t source,
+    std::vector<stinger_edge_update> insertions, std::vector<stinger_edge_update> deletions, bool run = true) {
+    alg.num_insertions = insertions.size();
+    alg.insertions = insertions.data();
+    alg.num_deletions = deletions.size();
+    alg.deletions = deletions.data();
+    bfs.onPre(&alg);
+    for (const stinger_edge_update &e : deletions) { stinger_remove_edge(S, 0, e.source, e.destination); }
+    for (const stinger_edge_update &e : insertions) { stinger_insert_edge(S, 0, e.source, e.destination, 1, 1); }
+    if (!run) { return; }
+
+    alg.max_active_vertex = stinger_max_active_vertex(S);
+    int64_t nv = alg.max_active_vertex + 1;
+    bfs.setSources({source});
+    bfs.onPost(&alg);
+
+    std::vector<int64_t> expected = search_each_source(nv, {source})[0];
+    int64_t * level = (int64_t *)alg.alg_data;
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_EQ(expected[v], level[v]) << "v = " << v;
+    }
+  }
+
+  static stinger_edge_update edge(int64_t u, int64_t v) {
+    stinger_edge_update e = {};
+    e.source = u;
+    e.destination = v;
+    return e;
+  }
+
+  struct stinger_config_t * stinger_config;
+  struct stinger * S;
+};
+
+TEST_F(BFSTest, DirectedGraph) {
+  stinger_insert_edge(S, 0, 0, 1, 1, 1);
+  stinger_insert_edge(S, 0, 1, 2, 1, 1);
+  stinger_insert_edge(S, 0, 1, 3, 1, 1);
+  stinger_insert_edge(S, 0, 1, 4, 1, 1);
+  stinger_insert_edge(S, 0, 2, 8, 1, 1);
+  stinger_insert_edge(S, 0, 3, 5, 1, 1);
+  stinger_insert_edge(S, 0, 3, 6, 1, 1);
+  stinger_insert_edge(S, 0, 4, 5, 1, 1);
+  stinger_insert_edge(S, 0, 5, 6, 1, 1);
+  stinger_insert_edge(S, 0, 5, 7, 1, 1);
+  stinger_insert_edge(S, 0, 7, 8, 1, 1);
+
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  std::vector<uint64_t> seen(nv), frontier(nv), next(nv);
+  std::vector<int64_t> level(nv);
+  int64_t source = 0;
+  multi_source_breadth_first_search(S, nv, &source, 1,
+    seen.data(), frontier.data(), next.data(), level.data(), NULL);
+
+  int64_t expected_level[9] = {0, 1, 2, 2, 2, 3, 3, 4, 3};
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_EQ(expected_level[v], level[v]) << "v = " << v;
+  }
+}
+
+TEST_F(BFSTest, MatchesSingleSource) {
+  // Two cliques joined by a path, with an unreachable vertex
+  for (int64_t u = 0; u < 8; u++) {
+    for (int64_t v = 0; v < 8; v++) {
+      if (u != v) {
+        stinger_insert_edge(S, 0, u, v, 1, 1);
+        stinger_insert_edge(S, 0, 20 + u, 20 + v, 1, 1);
+      }
+    }
+  }
+  for (int64_t v = 7; v < 20; v++) {
+    stinger_insert_edge_pair(S, 0, v, v + 1, 1, 1);
+  }
+  stinger_insert_edge(S, 0, 30, 0, 1, 1);
+
+  check_multi_source({3});
+  check_multi_source({0, 12, 25, 30});
+  // Every vertex as a source, plus duplicates
+  std::vector<int64_t> sources;
+  for (int64_t v = 0; v < 31; v++) { sources.push_back(v); sources.push_back(30 - v); }
+  check_multi_source(sources);
+}
+
+TEST_F(BFSTest, DirectionOptimizingDirectedGraph) {
+  stinger_insert_edge(S, 0, 0, 1, 1, 1);
+  stinger_insert_edge(S, 0, 1, 2, 1, 1);
+  stinger_insert_edge(S, 0, 1, 3, 1, 1);
+  stinger_insert_edge(S, 0, 1, 4, 1, 1);
+  stinger_insert_edge(S, 0, 2, 8, 1, 1);
+  stinger_insert_edge(S, 0, 3, 5, 1, 1);
+  stinger_insert_edge(S, 0, 3, 6, 1, 1);
+  stinger_insert_edge(S, 0, 4, 5, 1, 1);
+  stinger_insert_edge(S, 0, 5, 6, 1, 1);
+  stinger_insert_edge(S, 0, 5, 7, 1, 1);
+  stinger_insert_edge(S, 0, 7, 8, 1, 1);
+
+  // Bottom-up steps must follow in-edges, or 8 would be reached from 7 before 2
+  std::string directions = check_direction_optimizing({0}, 1e9, 1);
+  EXPECT_NE(std::string::npos, directions.find('B')) << directions;
+  // Default thresholds
+  check_direction_optimizing({0, 3, 8}, BFS_DEFAULT_ALPHA, BFS_DEFAULT_BETA);
+}
+
+TEST_F(BFSTest, DirectionOptimizingMatchesTopDown) {
+  // Two cliques joined by a path, with an unreachable vertex
+  for (int64_t u = 0; u < 8; u++) {
+    for (int64_t v = 0; v < 8; v++) {
+      if (u != v) {
+        stinger_insert_edge(S, 0, u, v, 1, 1);
+        stinger_insert_edge(S, 0, 20 + u, 20 + v, 1, 1);
+      }
+    }
+  }
+  for (int64_t v = 7; v < 20; v++) {
+    stinger_insert_edge_pair(S, 0, v, v + 1, 1, 1);
+  }
+  stinger_insert_edge(S, 0, 30, 0, 1, 1);
+
+  std::vector<int64_t> sources;
+  for (int64_t v = 0; v < 31; v++) { sources.push_back(v); }
+
+  // Never switch
+  std::string directions = check_direction_optimizing(sources, 0, BFS_DEFAULT_BETA);
+  EXPECT_EQ(std::string::npos, directions.find('B')) << directions;
+  // Switch to bottom-up as soon as the frontier grows, and back to top-down when it shrinks
+  directions = check_direction_optimizing(sources, 1e9, 1);
+  EXPECT_NE(std::string::npos, directions.find('B')) << directions;
+  // Stay bottom-up once switched
+  directions = check_direction_optimizing(sources, 1e9, 1e9);
+  EXPECT_NE(std::string::npos, directions.find('B')) << directions;
+  check_direction_optimizing(sources, BFS_DEFAULT_ALPHA, BFS_DEFAULT_BETA);
+}
+
+TEST_F(BFSTest, LargeFrontier) {
+  // Frontiers much larger than each thread's local queue
+  const int64_t width = 3000;
+  for (int64_t v = 1; v <= width; v++) {
+    stinger_insert_edge(S, 0, 0, v, 1, 1);
+    stinger_insert_edge(S, 0, v, width + v, 1, 1);
+  }
+
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  std::vector<std::vector<int64_t>> levels = search_each_source(nv, {0});
+  for (int64_t v = 0; v < nv; v++) {
+    int64_t expected = v == 0 ? 0 : (v <= width ? 1 : 2);
+    EXPECT_EQ(expected, levels[0][v]) << "v = " << v;
+  }
+  check_direction_optimizing({0}, BFS_DEFAULT_ALPHA, BFS_DEFAULT_BETA);
+  check_direction_optimizing({0}, 1e9, 1e9);
+}
+
+TEST_F(BFSTest, IncrementalMatchesFullSearch) {
+  // A path with some shortcuts
+  const int64_t n = 200;
+  for (int64_t v = 0; v < n - 1; v++) {
+    stinger_insert_edge(S, 0, v, v + 1, 1, 1);
+    stinger_insert_edge(S, 0, v, (v * 7 + 3) % n, 1, 1);
+  }
+
+  // Allow a repair no matter how many vertices change
+  gt::stinger::BreadthFirstSearch bfs(gt::stinger::BreadthFirstSearch::INCREMENTAL,
+    BFS_DEFAULT_ALPHA, BFS_DEFAULT_BETA, 1.0);
+  std::vector<int64_t> level(S->max_nv);
+  stinger_registered_alg alg = {};
+  alg.stinger = S;
+  alg.alg_data = level.data();
+  bfs.onInit(&alg);
+
+  // Nothing to repair from, so this is a full search
+  alg.max_active_vertex = stinger_max_active_vertex(S);
+  bfs.setSources({0});
+  bfs.onPost(&alg);
+
+  // Insertions lower levels
+  check_incremental(bfs, alg, 0, {edge(0, 150), edge(10, 100), edge(150, 220)}, {});
+  // Deletions raise levels and disconnect vertices
+  check_incremental(bfs, alg, 0, {}, {edge(0, 150), edge(50, 51), edge(0, 3), edge(150, 220)});
+  // Insertions and deletions together
+  check_incremental(bfs, alg, 0, {edge(3, 199), edge(0, 50)}, {edge(10, 100), edge(1, 2)});
+
+  // Several batches between searches, including an edge that is deleted and inserted again
+  check_incremental(bfs, alg, 0, {edge(5, 60)}, {edge(0, 1)}, false);
+  check_incremental(bfs, alg, 0, {edge(0, 1)}, {edge(5, 60)}, false);
+  check_incremental(bfs, alg, 0, {edge(60, 61)}, {edge(3, 199)});
+
+  // Another trial in the same epoch starts from the same levels and sees the same changes
+  std::vector<int64_t> previous = level;
+  check_incremental(bfs, alg, 0, {edge(20, 180)}, {edge(0, 50)});
+  std::vector<int64_t> first_trial = level;
+  level = previous;
+  bfs.onPost(&alg);
+  EXPECT_EQ(first_trial, level);
+
+  // A different source can't be repaired
+  check_incremental(bfs, alg, 5, {edge(5, 190)}, {});
+}
+
+int
+main (int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  // The traversal macros count edges, so the counters must exist even though we don't read them
+  // Hooks owns the counters (BreadthFirstSearch also reports stats through it)
+  Hooks::getInstance();
+  return RUN_ALL_TESTS();
+}
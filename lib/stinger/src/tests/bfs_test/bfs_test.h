@@ -0,0 +1,14 @@
+#ifndef STINGER_BFS_TEST_H_
+#define STINGER_BFS_TEST_H_
+
+extern "C" {
+  #include "stinger_alg/bfs.h"
+  #include "stinger_core/stinger.h"
+}
+
+#include "stinger_alg/dynamic_bfs.h"
+#include <hooks.h>
+#include "gtest/gtest.h"
+
+
+#endif /* STINGER_BFS_TEST_H_ */
@@ -1,5 +1,7 @@
 #include "pagerank_test.h"
 
+#include <vector>
+
 #define restrict
 
 class PagerankPrincetonTest : public ::testing::Test {
@@ -57,6 +59,33 @@ TEST_F(PagerankPrincetonTest, DirectedPagerank) {
   xfree(pr);
 }
 
+TEST_F(PagerankPrincetonTest, DirectedPagerankPull) {
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  tmp_pr = (double *)xcalloc(nv, sizeof(double));
+  pr = (double *)xcalloc(nv, sizeof(double));
+  double * expected_pr = (double *)xcalloc(nv, sizeof(double));
+
+  // Converges to the same ranks as page_rank, whether the last iteration lands in pr or tmp_pr
+  page_rank(S, nv, expected_pr, tmp_pr, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, 100);
+  int64_t iterations = page_rank_pull(S, nv, pr, tmp_pr, NULL, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, 100);
+  EXPECT_GT(iterations, 1);
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_NEAR(expected_pr[v], pr[v], 1e-12);
+  }
+  for (int64_t maxiter = 1; maxiter <= 2; maxiter++) {
+    for (int64_t v = 0; v < nv; v++) { pr[v] = expected_pr[v] = 0; }
+    page_rank(S, nv, expected_pr, tmp_pr, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, maxiter);
+    EXPECT_EQ(maxiter, page_rank_pull(S, nv, pr, tmp_pr, NULL, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, maxiter));
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_NEAR(expected_pr[v], pr[v], 1e-12);
+    }
+  }
+
+  xfree(expected_pr);
+  xfree(tmp_pr);
+  xfree(pr);
+}
+
 TEST_F(PagerankPrincetonTest, PagerankSubset) {
   for (int i=10; i < 100; i++) {
     int64_t timestamp = i+1;
@@ -142,4 +171,113 @@ TEST_F(PagerankPrincetonTest, PagerankDirectedType) {
 
   xfree(tmp_pr);
   xfree(pr);
-}
\ No newline at end of file
+}
+TEST_F(PagerankPrincetonTest, PushUpdatesRanks) {
+  // Grow the graph so some changes are far from each other, with a vertex that has no out-edges
+  for (int64_t v = 4; v < 200; v++) {
+    stinger_insert_edge(S, 0, v, (v * 7) % 199, 1, 1);
+    stinger_insert_edge(S, 0, v, v / 2, 1, 1);
+  }
+
+  int64_t max_nv = S->max_nv;
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  tmp_pr = (double *)xcalloc(max_nv, sizeof(double));
+  pr = (double *)xcalloc(max_nv, sizeof(double));
+  double * expected_pr = (double *)xcalloc(max_nv, sizeof(double));
+  page_rank_push_workspace_t * ws = page_rank_push_workspace_new(max_nv);
+
+  // Converge all the way, so the only residuals are from the changes
+  const double epsilon = 1e-12;
+  for (int64_t v = 0; v < nv; v++) { pr[v] = 1 / ((double)nv); }
+  page_rank_pull(S, nv, pr, tmp_pr, NULL, epsilon, DAMPINGFACTOR_DEFAULT, 10000);
+  double constant = -1;
+  int64_t touched = -1;
+  EXPECT_EQ(0, page_rank_push(ws, S, nv, pr, NULL, 0, &constant, epsilon, DAMPINGFACTOR_DEFAULT, &touched));
+  EXPECT_EQ(0, touched);
+
+  struct { int64_t u, v; bool insert; } changes[][3] = {
+    // Insertions
+    {{5, 150, true}, {150, 3, true}, {0, 3, true}},
+    // Deletions, including the only out-edge of a vertex
+    {{5, 150, false}, {3, 2, false}, {0, 1, false}},
+    // A new vertex
+    {{250, 5, true}, {5, 250, true}, {100, 101, true}},
+  };
+  for (int round = 0; round < 3; round++) {
+    std::vector<int64_t> seeds;
+    for (int i = 0; i < 3; i++) {
+      if (changes[round][i].insert) {
+        stinger_insert_edge(S, 0, changes[round][i].u, changes[round][i].v, 1, 1);
+      } else {
+        stinger_remove_edge(S, 0, changes[round][i].u, changes[round][i].v);
+      }
+      seeds.push_back(changes[round][i].u);
+      seeds.push_back(changes[round][i].v);
+    }
+    int64_t new_nv = stinger_max_active_vertex(S)+1;
+    for (int64_t v = nv; v < new_nv; v++) { seeds.push_back(v); }
+    nv = new_nv;
+
+    int64_t pushes = page_rank_push(ws, S, nv, pr, seeds.data(), seeds.size(), &constant, epsilon, DAMPINGFACTOR_DEFAULT, &touched);
+    EXPECT_GT(pushes, 0);
+    EXPECT_GT(touched, 0);
+
+    for (int64_t v = 0; v < nv; v++) { expected_pr[v] = 1 / ((double)nv); }
+    page_rank_pull(S, nv, expected_pr, tmp_pr, NULL, epsilon, DAMPINGFACTOR_DEFAULT, 10000);
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_NEAR(expected_pr[v], pr[v], 1e-10) << "round = " << round << ", v = " << v;
+    }
+  }
+
+  page_rank_push_workspace_free(ws);
+  xfree(expected_pr);
+  xfree(tmp_pr);
+  xfree(pr);
+}
+
+// With the same epsilon, a warm-started push should land as close to the converged ranks as a full pull does
+TEST_F(PagerankPrincetonTest, PushMatchesPullAtSameEpsilon) {
+  for (int64_t v = 4; v < 500; v++) {
+    stinger_insert_edge(S, 0, v, (v * 13) % 499, 1, 1);
+    stinger_insert_edge(S, 0, v, v / 3, 1, 1);
+  }
+
+  int64_t max_nv = S->max_nv;
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  tmp_pr = (double *)xcalloc(max_nv, sizeof(double));
+  pr = (double *)xcalloc(max_nv, sizeof(double));
+  double * pull_pr = (double *)xcalloc(max_nv, sizeof(double));
+  double * exact_pr = (double *)xcalloc(max_nv, sizeof(double));
+  page_rank_push_workspace_t * ws = page_rank_push_workspace_new(max_nv);
+
+  const double epsilon = EPSILON_DEFAULT;
+  for (int64_t v = 0; v < nv; v++) { pr[v] = 1 / ((double)nv); }
+  page_rank_pull(S, nv, pr, tmp_pr, NULL, epsilon, DAMPINGFACTOR_DEFAULT, 10000);
+  double constant = -1;
+  page_rank_push(ws, S, nv, pr, NULL, 0, &constant, epsilon, DAMPINGFACTOR_DEFAULT, NULL);
+
+  // Change a few edges, then update the ranks both ways
+  std::vector<int64_t> seeds = {7, 300, 300, 2, 0, 1};
+  stinger_insert_edge(S, 0, 7, 300, 1, 1);
+  stinger_insert_edge(S, 0, 300, 2, 1, 1);
+  stinger_remove_edge(S, 0, 0, 1);
+  page_rank_push(ws, S, nv, pr, seeds.data(), seeds.size(), &constant, epsilon, DAMPINGFACTOR_DEFAULT, NULL);
+
+  for (int64_t v = 0; v < nv; v++) { pull_pr[v] = exact_pr[v] = 1 / ((double)nv); }
+  page_rank_pull(S, nv, pull_pr, tmp_pr, NULL, epsilon, DAMPINGFACTOR_DEFAULT, 10000);
+  page_rank_pull(S, nv, exact_pr, tmp_pr, NULL, 1e-15, DAMPINGFACTOR_DEFAULT, 10000);
+
+  double push_error = 0, pull_error = 0;
+  for (int64_t v = 0; v < nv; v++) {
+    push_error += fabs(pr[v] - exact_pr[v]);
+    pull_error += fabs(pull_pr[v] - exact_pr[v]);
+  }
+  EXPECT_LT(pull_error, 10 * epsilon);
+  EXPECT_LT(push_error, 10 * epsilon);
+
+  page_rank_push_workspace_free(ws);
+  xfree(exact_pr);
+  xfree(pull_pr);
+  xfree(tmp_pr);
+  xfree(pr);
+}
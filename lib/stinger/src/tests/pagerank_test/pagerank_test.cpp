@@ -4,5 +4,9 @@ int
 main (int argc, char *argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
-  return RUN_ALL_TESTS();
+  // The traversal macros count edges, so the counters must exist even though we don't read them
+  dynograph_edge_count_init();
+  int rc = RUN_ALL_TESTS();
+  dynograph_edge_count_free();
+  return rc;
 }
\ No newline at end of file
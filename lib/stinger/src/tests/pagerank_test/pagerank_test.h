@@ -11,6 +11,7 @@ extern "C" {
   #include "stinger_utils/timer.h"
 }
 
+#include <edge_count.h>
 #include "gtest/gtest.h"
 
 
@@ -57,6 +57,33 @@ TEST_F(PagerankUndirectedPrincetonTest, Pagerank) {
   xfree(pr);
 }
 
+TEST_F(PagerankUndirectedPrincetonTest, PagerankPull) {
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  tmp_pr = (double *)xcalloc(nv, sizeof(double));
+  pr = (double *)xcalloc(nv, sizeof(double));
+  double * expected_pr = (double *)xcalloc(nv, sizeof(double));
+
+  // Converges to the same ranks as page_rank, whether the last iteration lands in pr or tmp_pr
+  page_rank(S, nv, expected_pr, tmp_pr, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, 100);
+  int64_t iterations = page_rank_pull(S, nv, pr, tmp_pr, NULL, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, 100);
+  EXPECT_GT(iterations, 1);
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_NEAR(expected_pr[v], pr[v], 1e-12);
+  }
+  for (int64_t maxiter = 1; maxiter <= 2; maxiter++) {
+    for (int64_t v = 0; v < nv; v++) { pr[v] = expected_pr[v] = 0; }
+    page_rank(S, nv, expected_pr, tmp_pr, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, maxiter);
+    EXPECT_EQ(maxiter, page_rank_pull(S, nv, pr, tmp_pr, NULL, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, maxiter));
+    for (int64_t v = 0; v < nv; v++) {
+      EXPECT_NEAR(expected_pr[v], pr[v], 1e-12);
+    }
+  }
+
+  xfree(expected_pr);
+  xfree(tmp_pr);
+  xfree(pr);
+}
+
 TEST_F(PagerankUndirectedPrincetonTest, PagerankSubset) {
   for (int i=10; i < 100; i++) {
     int64_t timestamp = i+1;
@@ -0,0 +1,116 @@
+#include "spmv_test.h"
+
+#include <vector>
+
+#define restrict
+
+typedef void (*dspmTv_fn)(const int64_t, const double, const struct stinger *, const double *, const double, double *);
+
+class SpMVTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    stinger_config = (struct stinger_config_t *)xcalloc(1,sizeof(struct stinger_config_t));
+    stinger_config->nv = 1<<13;
+    stinger_config->nebs = 1<<16;
+    stinger_config->netypes = 2;
+    stinger_config->nvtypes = 2;
+    stinger_config->memory_size = 1<<30;
+    S = stinger_new_full(stinger_config);
+    xfree(stinger_config);
+  }
+
+  virtual void TearDown() {
+    stinger_free_all(S);
+  }
+
+  // y = alpha * A^T * x + beta * y, scattering along each vertex's edges one at a time like the atomic variants do
+  std::vector<double> reference(int64_t nv, double alpha, const std::vector<double> &x, double beta,
+                                const std::vector<double> &y, bool unit, bool degscaled) {
+    std::vector<double> expected(nv);
+    for (int64_t j = 0; j < nv; j++) { expected[j] = beta * y[j]; }
+    for (int64_t i = 0; i < nv; i++) {
+      int64_t degi = stinger_outdegree_get(S, i);
+      double alphaxi = alpha * x[i];
+      if (degscaled) { alphaxi = degi == 0 ? 0.0 : alphaxi / degi; }
+      STINGER_FORALL_EDGES_OF_VTX_BEGIN(S, i) {
+        int64_t j = STINGER_EDGE_DEST;
+        if (i != j) { expected[j] += unit ? alphaxi : STINGER_EDGE_WEIGHT * alphaxi; }
+      } STINGER_FORALL_EDGES_OF_VTX_END();
+    }
+    return expected;
+  }
+
+  // Checks all four dense products against the reference
+  void check_dense(int64_t nv, double alpha, const std::vector<double> &x, double beta, const std::vector<double> &y) {
+    struct { const char * name; dspmTv_fn fn; bool unit, degscaled; } variants[] = {
+      {"stinger_dspmTv", stinger_dspmTv, false, false},
+      {"stinger_unit_dspmTv", stinger_unit_dspmTv, true, false},
+      {"stinger_dspmTv_degscaled", stinger_dspmTv_degscaled, false, true},
+      {"stinger_unit_dspmTv_degscaled", stinger_unit_dspmTv_degscaled, true, true},
+    };
+    for (auto &variant : variants) {
+      std::vector<double> expected = reference(nv, alpha, x, beta, y, variant.unit, variant.degscaled);
+      std::vector<double> actual(y);
+      variant.fn(nv, alpha, S, x.data(), beta, actual.data());
+      for (int64_t v = 0; v < nv; v++) {
+        EXPECT_NEAR(expected[v], actual[v], 1e-9 * (1 + fabs(expected[v]))) << variant.name << ", v = " << v;
+      }
+    }
+  }
+
+  struct stinger_config_t * stinger_config;
+  struct stinger * S;
+};
+
+TEST_F(SpMVTest, WeightedDirected) {
+  stinger_insert_edge(S, 0, 0, 1, 5, 1);
+  stinger_insert_edge(S, 0, 2, 1, 3, 1);
+  stinger_insert_edge(S, 0, 1, 2, 7, 1);
+  stinger_insert_edge(S, 0, 3, 0, 11, 1);
+
+  int64_t nv = 4;
+  std::vector<double> x = {1, 10, 100, 1000};
+  std::vector<double> y(nv, 0.0);
+
+  // Each weight is taken from the edge's source, never from the reverse edge
+  std::vector<double> expected = {11000, 305, 70, 0};
+  stinger_dspmTv(nv, 1.0, S, x.data(), 0.0, y.data());
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_DOUBLE_EQ(expected[v], y[v]) << "v = " << v;
+  }
+
+  check_dense(nv, 1.0, x, 0.0, std::vector<double>(nv, 0.0));
+}
+
+TEST_F(SpMVTest, MatchesReference) {
+  // Directed edges with different weights each way, some reciprocated, some removed, and a self loop
+  for (int64_t v = 0; v < 300; v++) {
+    stinger_insert_edge(S, 0, v, (v * 7 + 3) % 300, 1 + v % 5, 1);
+    stinger_insert_edge(S, 0, v, (v * 13) % 300, 2 + v % 3, 1);
+    if (v % 4 == 0) { stinger_insert_edge(S, 0, (v * 7 + 3) % 300, v, 10 + v % 7, 1); }
+  }
+  stinger_insert_edge(S, 0, 17, 17, 4, 1);
+  for (int64_t v = 0; v < 300; v += 5) {
+    stinger_remove_edge(S, 0, v, (v * 7 + 3) % 300);
+  }
+
+  int64_t nv = stinger_max_active_vertex(S)+1;
+  std::vector<double> x(nv), y(nv);
+  for (int64_t v = 0; v < nv; v++) {
+    x[v] = 1.0 / (1 + v % 17);
+    y[v] = (v % 5) - 2.0;
+  }
+
+  check_dense(nv, 0.85, x, 0.0, y);
+  check_dense(nv, 0.85, x, 1.0, y);
+  check_dense(nv, -1.0, x, 0.5, y);
+}
+
+int
+main (int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  // The traversal macros count edges, so the counters must exist even though we don't read them
+  Hooks::getInstance();
+  return RUN_ALL_TESTS();
+}
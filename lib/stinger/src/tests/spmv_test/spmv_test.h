@@ -0,0 +1,15 @@
+#ifndef STINGER_SPMV_TEST_H_
+#define STINGER_SPMV_TEST_H_
+
+extern "C" {
+  #include "stinger_alg/spmv_spmspv.h"
+  #include "stinger_core/stinger.h"
+  #include "stinger_core/stinger_traversal.h"
+  #include "stinger_core/xmalloc.h"
+}
+
+#include <hooks.h>
+#include "gtest/gtest.h"
+
+
+#endif /* STINGER_SPMV_TEST_H_ */
@@ -0,0 +1,124 @@
+#include "static_components_test.h"
+
+#include <vector>
+
+#define restrict
+
+class StaticComponentsTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    stinger_config = (struct stinger_config_t *)xcalloc(1,sizeof(struct stinger_config_t));
+    stinger_config->nv = 1<<13;
+    stinger_config->nebs = 1<<16;
+    stinger_config->netypes = 2;
+    stinger_config->nvtypes = 2;
+    stinger_config->memory_size = 1<<30;
+    S = stinger_new_full(stinger_config);
+    xfree(stinger_config);
+  }
+
+  virtual void TearDown() {
+    stinger_free_all(S);
+  }
+
+  // Labels each vertex with the smallest vertex it is connected to, ignoring edge direction
+  std::vector<int64_t> expected_components(int64_t nv) {
+    std::vector<int64_t> label(nv, -1);
+    std::vector<int64_t> stack;
+    for (int64_t root = 0; root < nv; root++) {
+      if (label[root] >= 0) continue;
+      label[root] = root;
+      stack.push_back(root);
+      while (!stack.empty()) {
+        int64_t u = stack.back();
+        stack.pop_back();
+        STINGER_FORALL_EDGES_OF_VTX_BEGIN(S, u) {
+          if (label[STINGER_EDGE_DEST] < 0) {
+            label[STINGER_EDGE_DEST] = root;
+            stack.push_back(STINGER_EDGE_DEST);
+          }
+        } STINGER_FORALL_EDGES_OF_VTX_END();
+      }
+    }
+    return label;
+  }
+
+  struct stinger_config_t * stinger_config;
+  struct stinger * S;
+};
+
+TEST_F(StaticComponentsTest, DirectedEdges) {
+  // 0 <- 1 <- 2 -> 3
+  stinger_insert_edge(S, 0, 1, 0, 1, 1);
+  stinger_insert_edge(S, 0, 2, 1, 1, 1);
+  stinger_insert_edge(S, 0, 2, 3, 1, 1);
+  // 4 <- 5, and 7 -> 6 with another edge type
+  stinger_insert_edge(S, 0, 5, 4, 1, 1);
+  stinger_insert_edge(S, 1, 7, 6, 1, 1);
+  // 8 -> 8 and vertex 9 on its own
+  stinger_insert_edge(S, 0, 8, 8, 1, 1);
+  stinger_insert_edge(S, 0, 10, 7, 1, 1);
+
+  int64_t nv = stinger_max_active_vertex(S) + 1;
+  std::vector<int64_t> components(nv);
+  afforest_components(S, nv, components.data());
+
+  int64_t expected[] = {0, 0, 0, 0, 4, 4, 6, 6, 8, 9, 6};
+  ASSERT_EQ(nv, 11);
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_EQ(components[v], expected[v]) << "vertex " << v;
+  }
+}
+
+TEST_F(StaticComponentsTest, MatchesShiloachVishkinOnUndirectedGraph) {
+  // Many small components
+  int64_t nv = 2000;
+  for (int64_t i = 0; i < 1500; i++) {
+    int64_t u = (i * 7919) % nv, v = (i * 104729 + 13) % nv;
+    stinger_insert_edge_pair(S, 0, u, v, 1, 1);
+  }
+  nv = stinger_max_active_vertex(S) + 1;
+
+  std::vector<int64_t> actual(nv), expected(nv);
+  afforest_components(S, nv, actual.data());
+  parallel_shiloach_vishkin_components(S, nv, expected.data());
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_EQ(actual[v], expected[v]) << "vertex " << v;
+  }
+}
+
+TEST_F(StaticComponentsTest, LargestComponentAndLongPaths) {
+  int64_t nv = 8000;
+  // A large component of random directed edges, which the sampling should find
+  for (int64_t i = 0; i < 12000; i++) {
+    int64_t u = (i * 7919) % 6000, v = (i * 104729 + 13) % 6000;
+    stinger_insert_edge(S, 0, u, v, 1, 1);
+  }
+  // Long paths outside of it, pointing both ways, one joining the large component at its far end
+  for (int64_t v = 6000; v < 6999; v++) {
+    stinger_insert_edge(S, v % 2, v + 1, v, 1, 1);
+  }
+  for (int64_t v = 7000; v < nv - 1; v++) {
+    stinger_insert_edge(S, 0, v, v + 1, 1, 1);
+  }
+  stinger_insert_edge(S, 0, nv - 1, 5999, 1, 1);
+
+  nv = stinger_max_active_vertex(S) + 1;
+  std::vector<int64_t> actual(nv);
+  afforest_components(S, nv, actual.data());
+  std::vector<int64_t> expected = expected_components(nv);
+  for (int64_t v = 0; v < nv; v++) {
+    EXPECT_EQ(actual[v], expected[v]) << "vertex " << v;
+  }
+}
+
+int
+main (int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  // The traversal macros count edges, so the counters must exist even though we don't read them
+  dynograph_edge_count_init();
+  int rc = RUN_ALL_TESTS();
+  dynograph_edge_count_free();
+  return rc;
+}
@@ -0,0 +1,13 @@
+#ifndef STINGER_STATIC_COMPONENTS_TEST_H_
+#define STINGER_STATIC_COMPONENTS_TEST_H_
+
+extern "C" {
+  #include "stinger_alg/static_components.h"
+  #include "stinger_core/stinger.h"
+}
+
+#include <edge_count.h>
+#include "gtest/gtest.h"
+
+
+#endif /* STINGER_STATIC_COMPONENTS_TEST_H_ */
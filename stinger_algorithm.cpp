@@ -25,6 +25,7 @@ extern "C" {
 #include <stinger_alg/dynamic_clustering.h>
 #include <stinger_alg/dynamic_kcore.h>
 #include <stinger_alg/dynamic_pagerank.h>
+#include <stinger_alg/dynamic_pagerank_push.h>
 #include <stinger_alg/dynamic_pagerank_updating.h>
 #include <stinger_alg/dynamic_simple_communities.h>
 #include <stinger_alg/dynamic_simple_communities_updating.h>
@@ -45,7 +46,11 @@ using namespace gt::stinger;
 const vector<string>
 StingerAlgorithm::supported_algs = {
     "bc",
+    "bc_updating",
     "bfs",
+    "top_down_bfs",
+    "ms_bfs",
+    "bfs_updating",
     "cc",
     "clustering",
     "simple_communities",
@@ -53,6 +58,7 @@ StingerAlgorithm::supported_algs = {
     "streaming_cc",
     "kcore",
     "pagerank",
+    "pagerank_push",
     "pagerank_updating"
 };
 
@@ -60,8 +66,16 @@ shared_ptr<IDynamicGraphAlgorithm> createImplementation(string name)
 {
     if        (name == "bc") {
         return make_shared<BetweennessCentrality>(128, 0.5, 1);
+    } else if (name == "bc_updating") {
+        return make_shared<BetweennessCentrality>(128, 0.5, 1, BetweennessCentrality::INCREMENTAL);
     } else if (name == "bfs") {
-        return make_shared<BreadthFirstSearch>();
+        return make_shared<BreadthFirstSearch>(BreadthFirstSearch::DIRECTION_OPTIMIZING);
+    } else if (name == "top_down_bfs") {
+        return make_shared<BreadthFirstSearch>(BreadthFirstSearch::TOP_DOWN);
+    } else if (name == "ms_bfs") {
+        return make_shared<BreadthFirstSearch>(BreadthFirstSearch::MULTI_SOURCE);
+    } else if (name == "bfs_updating") {
+        return make_shared<BreadthFirstSearch>(BreadthFirstSearch::INCREMENTAL);
     } else if (name == "cc") {
         return make_shared<ConnectedComponents>();
     } else if (name == "clustering") {
@@ -76,6 +90,8 @@ shared_ptr<IDynamicGraphAlgorithm> createImplementation(string name)
         return make_shared<KCore>();
     } else if (name == "pagerank") {
         return make_shared<PageRank>("", false, true, EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, MAXITER_DEFAULT);
+    } else if (name == "pagerank_push") {
+        return make_shared<PageRankPush>(EPSILON_DEFAULT, DAMPINGFACTOR_DEFAULT, MAXITER_DEFAULT);
     } else if (name == "pagerank_updating") {
         return make_shared<PageRankUpdating>("dprheld", 0.85, 0, 1.0);
     } else {
@@ -161,7 +177,11 @@ StingerAlgorithm::get_data_ptr()
     // Decide which one we want
     string desc;
     if        (name == "bc") { desc = "bc";
+    } else if (name == "bc_updating") { desc = "bc";
     } else if (name == "bfs") { desc = "level";
+    } else if (name == "top_down_bfs") { desc = "level";
+    } else if (name == "ms_bfs") { desc = "level";
+    } else if (name == "bfs_updating") { desc = "level";
     } else if (name == "cc") { desc = "component_label";
     } else if (name == "clustering") { desc = "coeff";
     } else if (name == "simple_communities") { desc = "community_label";
@@ -169,6 +189,7 @@ StingerAlgorithm::get_data_ptr()
     } else if (name == "streaming_cc") { desc = "component_label";
     } else if (name == "kcore") { desc = "kcore";
     } else if (name == "pagerank") { desc = "pagerank";
+    } else if (name == "pagerank_push") { desc = "pagerank";
     } else if (name == "pagerank_updating") { desc = "dprheld";
     } else {
         cerr << "Algorithm " << name << " not implemented!\n";
@@ -33,6 +33,8 @@ public:
     void setSources(const std::vector<int64_t> &sources);
     void getData(DynoGraph::Range<int64_t>& data);
     void setData(const DynoGraph::Range<int64_t>& data);
+    // Size of the per-vertex data allocated for this algorithm, in bytes
+    size_t getDataSize() const { return alg_data.size(); }
 
     void onInit();
     void onPre();
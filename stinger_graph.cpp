@@ -14,6 +14,7 @@ extern "C" {
 #include <stinger_net/stinger_alg.h>
 #include <stinger_core/stinger_batch_insert.h>
 #include <dynograph_edge_count.h>
+#include <update_latency.h>
 
 using std::cerr;
 
@@ -286,12 +287,14 @@ StingerGraph::insert_using_parallel_for_dynamic_schedule(const DynoGraph::Batch&
     OMP("omp parallel for schedule(dynamic, chunksize)")
     for (auto e = batch.begin(); e < batch.end(); ++e)
     {
+        DYNOGRAPH_UPDATE_LATENCY_BEGIN(1);
         if (directed)
         {
             stinger_incr_edge     (S, type, e->src, e->dst, e->weight, e->timestamp);
         } else { // undirected
             stinger_incr_edge_pair(S, type, e->src, e->dst, e->weight, e->timestamp);
         }
+        DYNOGRAPH_UPDATE_LATENCY_END();
     }
 }
 
@@ -305,12 +308,14 @@ StingerGraph::insert_using_parallel_for_static_schedule(const DynoGraph::Batch&
     OMP("omp parallel for schedule(static)")
     for (auto e = batch.begin(); e < batch.end(); ++e)
     {
+        DYNOGRAPH_UPDATE_LATENCY_BEGIN(1);
         if (directed)
         {
             stinger_incr_edge     (S, type, e->src, e->dst, e->weight, e->timestamp);
         } else { // undirected
             stinger_incr_edge_pair(S, type, e->src, e->dst, e->weight, e->timestamp);
         }
+        DYNOGRAPH_UPDATE_LATENCY_END();
     }
 }
 
@@ -323,7 +328,9 @@ StingerGraph::deleteOlderThan(int64_t threshold)
         DYNOGRAPH_EDGE_COUNT_TRAVERSE_EDGE();
         if (STINGER_EDGE_TIME_RECENT < threshold) {
             // Delete the edge
+            DYNOGRAPH_UPDATE_LATENCY_BEGIN(1);
             update_edge_data_and_direction (S, current_eb__, i__, ~STINGER_EDGE_DEST, 0, 0, STINGER_EDGE_DIRECTION, EDGE_WEIGHT_SET);
+            DYNOGRAPH_UPDATE_LATENCY_END();
         }
     }
     STINGER_RAW_FORALL_EDGES_OF_ALL_TYPES_END();
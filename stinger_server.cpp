@@ -9,6 +9,7 @@
 #include <cmath>
 
 #include <hooks.h>
+#include <update_latency.h>
 #include <dynograph_util/logger.h>
 #include <stinger_core/stinger_atomics.h>
 #include "stinger_server.h"
@@ -146,6 +147,19 @@ StingerServer::onGraphChange()
 #ifdef STINGER_DYNOGRAPH_RECORD_GRAPH_STATS
     recordGraphStats();
 #endif
+#ifdef ENABLE_DYNOGRAPH_MEMORY_STATS
+    recordMemoryStats();
+#endif
+}
+
+void
+StingerServer::recordMemoryStats()
+{
+    // Edge blocks are allocated from the pool in order, so the tail tells us how many are in use
+    MAP_STING(graph.S);
+    Hooks &hooks = Hooks::getInstance();
+    hooks.set_stat("stinger_bytes", static_cast<int64_t>(stinger_graph_size(graph.S)));
+    hooks.set_stat("stinger_edge_block_bytes", static_cast<int64_t>(ebpool->ebpool_tail * sizeof(struct stinger_eb)));
 }
 
 void
@@ -154,9 +168,9 @@ StingerServer::recordGraphStats()
     int64_t nv = max_active_vertex + 1;
     stinger_fragmentation_t stats;
     stinger_fragmentation (graph.S, nv, &stats);
-    int64_t num_active_vertices = stinger_num_active_vertices(graph.S);
-    int64_t num_edges = stinger_edges_up_to(graph.S, nv);
-    DegreeStats d = compute_degree_distribution(graph);
+    // Count active vertices in the same pass as the degree distribution
+    int64_t num_active_vertices;
+    DegreeStats d = compute_degree_distribution(graph, &num_active_vertices);
 
     Hooks &hooks = Hooks::getInstance();
     hooks.set_stat("num_active_vertices", num_active_vertices);
@@ -173,6 +187,7 @@ StingerServer::recordGraphStats()
 void
 StingerServer::insert_batch(const DynoGraph::Batch & b)
 {
+    dynograph_update_latency_reset();
     if (args.sort_mode == DynoGraph::Args::SORT_MODE::SNAPSHOT) {
         graph.insert_using_set_initial_edges(b);
     } else {
@@ -184,12 +199,15 @@ StingerServer::insert_batch(const DynoGraph::Batch & b)
         graph.insert_using_parallel_for_static_schedule(b);
 #endif
     }
+    dynograph_update_latency_report();
     onGraphChange();
 }
 
 void
 StingerServer::delete_edges_older_than(int64_t threshold) {
+    dynograph_update_latency_reset();
     graph.deleteOlderThan(threshold);
+    dynograph_update_latency_report();
     onGraphChange();
 }
 
@@ -209,6 +227,9 @@ StingerServer::update_alg(const string& name, const std::vector<int64_t> &source
     alg->setData(data);
     // Run the algorithm
     alg->onPost();
+#ifdef ENABLE_DYNOGRAPH_MEMORY_STATS
+    Hooks::getInstance().set_stat("alg_data_bytes", static_cast<int64_t>(alg->getDataSize()));
+#endif
     // Copy result data to buffer
     alg->getData(data);
 }
@@ -234,77 +255,113 @@ StingerServer::get_num_edges() const
 std::vector<int64_t>
 StingerServer::get_high_degree_vertices(int64_t n) const
 {
-    using DynoGraph::vertex_degree;
     int64_t nv = this->get_num_vertices();
     assert(n < nv);
 
-    std::vector<vertex_degree> degrees(nv);
-    #pragma omp parallel for
-    for (int64_t i = 0; i < nv; ++i) {
-        int64_t degree = stinger_outdegree_get(graph.S, i);
-        degrees[i] = vertex_degree(i, degree);
-    }
-    // order by degree descending, vertex_id ascending
-    std::sort(degrees.begin(), degrees.end());
-
-    degrees.erase(degrees.begin(), degrees.end() - n);
-    std::vector<int64_t> ids(degrees.size());
-    std::transform(degrees.begin(), degrees.end(), ids.begin(),
-        [](const vertex_degree &d) { return d.vertex_id; });
-    return ids;
+    const stinger_t * S = graph.S;
+    return DynoGraph::top_k_vertices(n, nv,
+        [S](int64_t v) { return stinger_outdegree_get(S, v); });
 }
 
 /**
  * Computes the mean, variance, max, and skew of the (in/out)degree of all vertices in the graph
  */
 
-template <typename getter>
-StingerServer::DistributionSummary
-summarize(int64_t n, getter get)
+// Running sums of x, x^2 and x^3, so the moments of a distribution can be computed in a single pass
+struct MomentSums
 {
-    StingerServer::DistributionSummary d = {};
+    int64_t max;
+    long double sum, sum_sq, sum_cube;
+
+    MomentSums() : max(0), sum(0), sum_sq(0), sum_cube(0) {}
+
+    void add(int64_t x)
+    {
+        long double lx = x;
+        sum += lx;
+        sum_sq += lx * lx;
+        sum_cube += lx * lx * lx;
+        if (x > max) { max = x; }
+    }
+
+    void merge(const MomentSums& other)
+    {
+        sum += other.sum;
+        sum_sq += other.sum_sq;
+        sum_cube += other.sum_cube;
+        if (other.max > max) { max = other.max; }
+    }
 
-    // First pass: compute mean and max
-    int64_t max = 0;
-    int64_t mean_sum = 0;
-    OMP("omp parallel for reduction(max : max), reduction(+ : mean_sum)")
-    for (int64_t v = 0; v < n; ++v)
+    StingerServer::DistributionSummary
+    summarize(int64_t n) const
     {
-        int64_t degree = get(v);
-        mean_sum += degree;
-        if (degree > max) { max = degree; }
+        StingerServer::DistributionSummary d = {};
+        if (n == 0) { return d; }
+        // Convert raw moments to central moments about the mean
+        long double mean = sum / n;
+        long double m2 = sum_sq / n - mean * mean;
+        long double m3 = sum_cube / n - 3 * mean * (sum_sq / n) + 2 * mean * mean * mean;
+        d.mean = mean;
+        d.max = max;
+        d.variance = m2;
+        // Sum of cubed deviations over variance^1.5, as reported in previous versions
+        d.skew = (n * m3) / std::pow(m2, 1.5L);
+        return d;
     }
-    d.mean = static_cast<double>(mean_sum) / n;
-    d.max = max;
-
-    // Second pass: compute second and third central moments about the mean (for variance and skewness)
-    double x2_sum = 0;
-    double x3_sum = 0;
-    OMP("omp parallel for reduction(+ : x2_sum, x3_sum)")
-    for (int64_t v = 0; v < n; ++v)
+};
+
+// Summarizes the degree distributions of n vertices in a single pass
+// get(i, in, out, both) should fill in the in, out and total degree of the i'th vertex
+// If num_active is not null, it is set to the number of vertices with nonzero in or out degree
+template <typename getter>
+StingerServer::DegreeStats
+summarize_degrees(int64_t n, getter get, int64_t *num_active = nullptr)
+{
+    MomentSums in_sums, out_sums, both_sums;
+    int64_t active = 0;
+    OMP("omp parallel")
     {
-        int64_t degree = get(v);
-        x2_sum += pow(degree - d.mean, 2);
-        x3_sum += pow(degree - d.mean, 3);
+        MomentSums my_in, my_out, my_both;
+        int64_t my_active = 0;
+        OMP("omp for nowait")
+        for (int64_t v = 0; v < n; ++v)
+        {
+            int64_t in, out, both;
+            get(v, in, out, both);
+            my_in.add(in);
+            my_out.add(out);
+            my_both.add(both);
+            if (in > 0 || out > 0) { my_active += 1; }
+        }
+        OMP("omp critical")
+        {
+            in_sums.merge(my_in);
+            out_sums.merge(my_out);
+            both_sums.merge(my_both);
+            active += my_active;
+        }
     }
-    d.variance = x2_sum / n;
-    d.skew = x3_sum / pow(d.variance, 1.5);
 
-    return d;
+    StingerServer::DegreeStats stats;
+    stats.both = both_sums.summarize(n);
+    stats.in   = in_sums.summarize(n);
+    stats.out  = out_sums.summarize(n);
+    if (num_active) { *num_active = active; }
+    return stats;
 }
 
 // Computes the degree distribution of the graph
 StingerServer::DegreeStats
-StingerServer::compute_degree_distribution(StingerGraph& g)
+StingerServer::compute_degree_distribution(StingerGraph& g, int64_t *num_active_vertices)
 {
     int64_t n = max_active_vertex + 1;
-    DegreeStats stats;
     const stinger_t *S = g.S;
-
-    stats.both = summarize(n, [S](int64_t i) { return stinger_degree_get(S, i); });
-    stats.in   = summarize(n, [S](int64_t i) { return stinger_indegree_get(S, i); });
-    stats.out  = summarize(n, [S](int64_t i) { return stinger_outdegree_get(S, i); });
-    return stats;
+    return summarize_degrees(n,
+        [S](int64_t i, int64_t &in, int64_t &out, int64_t &both) {
+            in = stinger_indegree_get(S, i);
+            out = stinger_outdegree_get(S, i);
+            both = stinger_degree_get(S, i);
+        }, num_active_vertices);
 }
 
 // Computes the degree distribution of the batch (treating the edge list as a graph)
@@ -319,25 +376,22 @@ StingerServer::compute_degree_distribution(const DynoGraph::Batch& b)
             [](const DynoGraph::Edge& a, const DynoGraph::Edge& b) { return a.dst < b.dst; }
     )->dst;
     int64_t n = std::max(max_src, max_dst) + 1;
-    vector<int64_t> degree(n);
     vector<int64_t> in_degree(n);
     vector<int64_t> out_degree(n);
     OMP("omp parallel for")
     for (auto e = b.begin(); e < b.end(); ++e)
     {
-        stinger_int64_fetch_add(&degree[e->src], 1);
-        stinger_int64_fetch_add(&degree[e->dst], 1);
         stinger_int64_fetch_add(&out_degree[e->src], 1);
         stinger_int64_fetch_add(&in_degree[e->dst], 1);
     }
 
     // Summarize
-    DegreeStats stats;
-    stats.both = summarize(n, [&degree]    (int64_t i) { return degree[i]; });
-    stats.in   = summarize(n, [&in_degree] (int64_t i) { return in_degree[i]; });
-    stats.out  = summarize(n, [&out_degree](int64_t i) { return out_degree[i]; });
-
-    return stats;
+    return summarize_degrees(n,
+        [&in_degree, &out_degree](int64_t i, int64_t &in, int64_t &out, int64_t &both) {
+            in = in_degree[i];
+            out = out_degree[i];
+            both = in + out;
+        });
 }
 
 // Computes the degree distribution of the vertices in the graph that will be updated by this batch
@@ -356,13 +410,13 @@ StingerServer::compute_degree_distribution(StingerGraph& g, const DynoGraph::Bat
     unique_batch_vertices.erase(end, unique_batch_vertices.end());
 
     // Compute degree distribution for only the vertices in the batch
-    DegreeStats stats;
     const stinger_t *S = g.S;
     int64_t n = unique_batch_vertices.size();
     const vector<int64_t> &v = unique_batch_vertices;
-
-    stats.both = summarize(n, [S, v](int64_t i) { return stinger_degree_get(S, v[i]); });
-    stats.in   = summarize(n, [S, v](int64_t i) { return stinger_indegree_get(S, v[i]); });
-    stats.out  = summarize(n, [S, v](int64_t i) { return stinger_outdegree_get(S, v[i]); });
-    return stats;
-}
\ No newline at end of file
+    return summarize_degrees(n,
+        [S, &v](int64_t i, int64_t &in, int64_t &out, int64_t &both) {
+            in = stinger_indegree_get(S, v[i]);
+            out = stinger_outdegree_get(S, v[i]);
+            both = stinger_degree_get(S, v[i]);
+        });
+}
@@ -22,6 +22,7 @@ private:
 
     void onGraphChange();
     void recordGraphStats();
+    void recordMemoryStats();
 public:
 
     StingerServer(const DynoGraph::Args& args, int64_t max_nv);
@@ -54,7 +55,7 @@ public:
     DegreeStats
     compute_degree_distribution(const DynoGraph::Batch& b);
     DegreeStats
-    compute_degree_distribution(StingerGraph& g);
+    compute_degree_distribution(StingerGraph& g, int64_t *num_active_vertices = nullptr);
     DegreeStats
     compute_degree_distribution(StingerGraph &g, const DynoGraph::Batch &b);
 };